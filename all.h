@@ -18,5 +18,32 @@
 #include "window.h"
 #include "canvas.h"
 #include "group.h"
+#include "layered_canvas.h"
+#include "worker_pool.h"
+#include "command_list.h"
+#include "png_writer.h"
+#include "software_canvas.h"
+#include "pixel_buffer.h"
+#include "sprite.h"
+#include "collision.h"
+#include "image_cache.h"
+#include "resample.h"
+#include "mipmap.h"
+#include "tiled_image.h"
+#include "gallery.h"
+#include "filter.h"
+#include "asset_bundle.h"
+#include "animated_image.h"
+#include "callbacks.h"
+#include "label_pool.h"
+#include "footprint.h"
+#include "widget_arena.h"
+#include "virtual_list.h"
+#include "layout.h"
+#include "spatial_index.h"
+#include "render_cache.h"
+#include "polygon_button.h"
+#include "hex_grid.h"
+#include "text_layout.h"
 
 #endif
\ No newline at end of file
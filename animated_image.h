@@ -0,0 +1,394 @@
+#ifndef BOBCAT_UI_ANIMATED_IMAGE
+#define BOBCAT_UI_ANIMATED_IMAGE
+
+#include "textbox.h"
+#include "asset_bundle.h"
+#include "image_cache.h"
+#include "pixel_buffer.h"
+#include "resample.h"
+#include <FL/Fl.H>
+#include <FL/Fl_Window.H>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bobcat {
+
+/**
+ * @class FrameSet
+ * @brief The decoded frames of an animation, shared by every widget that plays it.
+ *
+ * Frame sets are built once per source by strip() or sequence() and once
+ * more per display size by scaled(); later requests for the same source or
+ * size get the existing set for as long as some widget holds it.
+ */
+class FrameSet {
+    std::vector<Fl_RGB_Image *> frames; // Decoded frames, owned
+    std::string name; // Key of the set in the registry
+
+    // Get the registry of live frame sets by key
+    static std::map<std::string, std::weak_ptr<FrameSet>> &registry() {
+        static std::map<std::string, std::weak_ptr<FrameSet>> sets;
+        return sets;
+    }
+
+    static std::mutex &registryLock() {
+        static std::mutex lock;
+        return lock;
+    }
+
+    // Get a live frame set by key, building it if no widget holds it
+    static std::shared_ptr<FrameSet> shared(const std::string &key, const std::function<void(FrameSet &)> &build) {
+        std::lock_guard<std::mutex> guard(registryLock());
+        std::map<std::string, std::weak_ptr<FrameSet>> &sets = registry();
+        for (std::map<std::string, std::weak_ptr<FrameSet>>::iterator it = sets.begin(); it != sets.end();) {
+            if (it->second.expired()) {
+                it = sets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        std::shared_ptr<FrameSet> set = sets[key].lock();
+        if (!set) {
+            set = std::make_shared<FrameSet>();
+            set->name = key;
+            build(*set);
+            sets[key] = set;
+        }
+        return set;
+    }
+
+public:
+    // Get the frames of a sprite strip, split into count frames along its longer side
+    static std::shared_ptr<FrameSet> strip(const std::string &filename, int count) {
+        return shared(filename + "#" + std::to_string(count), [&](FrameSet &set) {
+            std::shared_ptr<Fl_PNG_Image> png = ImageCache::shared().load(filename);
+            PixelBuffer all = PixelBuffer::fromImage(png.get());
+            if (all.empty() || count <= 0) return;
+            bool horizontal = all.w >= all.h;
+            int fw = horizontal ? all.w / count : all.w;
+            int fh = horizontal ? all.h : all.h / count;
+            if (fw <= 0 || fh <= 0) return;
+            for (int i = 0; i < count; i++) {
+                PixelBuffer frame(fw, fh);
+                int ox = horizontal ? i * fw : 0;
+                int oy = horizontal ? 0 : i * fh;
+                for (int y = 0; y < fh; y++) {
+                    memcpy(frame.row(y), all.row(oy + y) + (size_t)ox * 4, (size_t)fw * 4);
+                }
+                set.frames.push_back(frame.toImage());
+            }
+        });
+    }
+
+    // Get the frames of numbered files, pattern is a printf format such as "spin_%02d.png"
+    static std::shared_ptr<FrameSet> sequence(const std::string &pattern, int first, int count) {
+        return shared(pattern + "#" + std::to_string(first) + "+" + std::to_string(count), [&](FrameSet &set) {
+            for (int i = 0; i < count; i++) {
+                char filename[1024];
+                snprintf(filename, sizeof(filename), pattern.c_str(), first + i);
+                std::unique_ptr<Fl_PNG_Image> png(AssetBundle::loadPNG(filename));
+                PixelBuffer frame = PixelBuffer::fromImage(png.get());
+                if (!frame.empty()) set.frames.push_back(frame.toImage());
+            }
+        });
+    }
+
+    // Get the frames scaled to fit a w x h box, keeping their aspect ratio
+    std::shared_ptr<FrameSet> scaled(int w, int h) const {
+        if (frames.empty() || w <= 0 || h <= 0) return nullptr;
+        int fw = frames[0]->w();
+        int fh = frames[0]->h();
+        double scale = std::min((double)w / fw, (double)h / fh);
+        int sw = std::max(1, (int)(fw * scale));
+        int sh = std::max(1, (int)(fh * scale));
+
+        const std::vector<Fl_RGB_Image *> &source = frames;
+        return shared(name + "@" + std::to_string(sw) + "x" + std::to_string(sh), [&](FrameSet &set) {
+            for (size_t i = 0; i < source.size(); i++) {
+                Fl_RGB_Image *frame = Resampler::resize(source[i], sw, sh, RESAMPLE_BICUBIC);
+                if (frame) set.frames.push_back(frame);
+            }
+        });
+    }
+
+    // Get the number of frames
+    int count() const {
+        return (int)frames.size();
+    }
+
+    // Get a frame
+    Fl_RGB_Image *frame(int index) const {
+        return frames[index];
+    }
+
+    // Destructor to delete the frames
+    ~FrameSet() {
+        for (size_t i = 0; i < frames.size(); i++) {
+            delete frames[i];
+        }
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+/**
+ * @class AnimationClock
+ * @brief One timer that drives every running animation.
+ *
+ * Subscribers are called on the UI thread with the current time in seconds.
+ * The timer only runs while there are subscribers, so idle programs do not
+ * wake up.
+ */
+class AnimationClock {
+    std::map<int, std::function<void(double)>> subscribers; // Callbacks by id
+    int nextId; // Id of the next subscriber
+    double interval; // Seconds between ticks
+    bool ticking; // Subscribers are being called, the timer is re-armed afterwards
+
+    AnimationClock() {
+        nextId = 1;
+        interval = 1.0 / 60;
+        ticking = false;
+    }
+
+    static void tick(void *data) {
+        AnimationClock *self = (AnimationClock *)data;
+        double t = now();
+        self->ticking = true;
+        // Subscribers may unsubscribe while being called
+        std::vector<int> ids;
+        for (std::map<int, std::function<void(double)>>::iterator it = self->subscribers.begin(); it != self->subscribers.end(); ++it) {
+            ids.push_back(it->first);
+        }
+        for (size_t i = 0; i < ids.size(); i++) {
+            std::map<int, std::function<void(double)>>::iterator it = self->subscribers.find(ids[i]);
+            if (it == self->subscribers.end()) continue;
+            std::function<void(double)> cb = it->second;
+            cb(t);
+        }
+        self->ticking = false;
+        if (!self->subscribers.empty()) Fl::repeat_timeout(self->interval, tick, data);
+    }
+
+public:
+    // Get the clock shared by all bobcat widgets
+    static AnimationClock &shared() {
+        static AnimationClock clock;
+        return clock;
+    }
+
+    // Get the current time in seconds
+    static double now() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Call a function on every tick, returns an id for unsubscribe
+    int subscribe(std::function<void(double)> cb) {
+        int id = nextId++;
+        subscribers[id] = cb;
+        if (subscribers.size() == 1 && !ticking) Fl::add_timeout(interval, tick, this);
+        return id;
+    }
+
+    // Stop calling a function
+    void unsubscribe(int id) {
+        subscribers.erase(id);
+        if (subscribers.empty()) Fl::remove_timeout(tick, this);
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+/**
+ * @class AnimatedImage
+ * @brief Plays a FrameSet at a fixed frame rate.
+ *
+ * Frames are decoded and scaled once and shared with every other widget
+ * playing the same source at the same size. Each frame change only damages
+ * the area of the widget.
+ */
+class AnimatedImage : public TextBox {
+    std::shared_ptr<FrameSet> source; // Frames at their original size
+    std::shared_ptr<FrameSet> frames; // Frames scaled to the box
+    int current; // Index of the frame shown
+    double rate; // Frames per second
+    bool looping; // Start over after the last frame
+    int clockId; // Subscription to the clock, 0 when stopped
+    double started; // Clock time of frame 0 of the current run
+    int startFrame; // Frame shown at started
+
+    // Scale the frames to the box and show the current frame
+    void fit() {
+        frames = source ? source->scaled(Fl_Box::w(), Fl_Box::h()) : nullptr;
+        showFrame();
+    }
+
+    // Show the current frame, damaging only the widget's area
+    void showFrame() {
+        image(frames && frames->count() > 0 ? frames->frame(current) : nullptr);
+        Fl_Window *win = window();
+        if (box() == FL_NO_BOX && win) {
+            // Transparent frames need the background under the widget redrawn, but nothing else
+            win->damage(FL_DAMAGE_ALL, x(), y(), w(), h());
+        } else {
+            redraw();
+        }
+    }
+
+    // Advance to the frame due at time t
+    void tick(double t) {
+        if (!frames || frames->count() == 0) return;
+        int n = frames->count();
+        int due = startFrame + (int)((t - started) * rate);
+        if (due >= n && !looping) {
+            due = n - 1;
+            stop();
+            if (due != current) {
+                current = due;
+                showFrame();
+            }
+            CallbackTable::fire(this, EVENT_FINISH);
+            return;
+        }
+        due %= n;
+        if (due != current) {
+            current = due;
+            showFrame();
+        }
+    }
+
+public:
+    // Constructor to initialize the widget with position and size
+    AnimatedImage(int x, int y, int w, int h) : TextBox(x, y, w, h) {
+        current = 0;
+        rate = 12;
+        looping = true;
+        clockId = 0;
+        started = 0;
+        startFrame = 0;
+        Fl_Box::align(FL_ALIGN_IMAGE_MASK);
+    }
+
+    // Load the frames of a sprite strip split into count frames
+    void loadStrip(std::string filename, int count) {
+        source = FrameSet::strip(filename, count);
+        current = 0;
+        fit();
+    }
+
+    // Load the frames of numbered files, pattern is a printf format such as "spin_%02d.png"
+    void loadSequence(std::string pattern, int first, int count) {
+        source = FrameSet::sequence(pattern, first, count);
+        current = 0;
+        fit();
+    }
+
+    // Play from a frame set already loaded by another widget
+    void frameSet(std::shared_ptr<FrameSet> set) {
+        source = set;
+        current = 0;
+        fit();
+    }
+
+    // Get the frames at their original size
+    std::shared_ptr<FrameSet> frameSet() const {
+        return source;
+    }
+
+    // Start playing from the current frame
+    void play() {
+        if (clockId) return;
+        started = AnimationClock::now();
+        startFrame = current;
+        clockId = AnimationClock::shared().subscribe([this](double t) { tick(t); });
+    }
+
+    // Stop playing, the current frame stays visible
+    void stop() {
+        if (!clockId) return;
+        AnimationClock::shared().unsubscribe(clockId);
+        clockId = 0;
+    }
+
+    // Check if the animation is playing
+    bool playing() const {
+        return clockId != 0;
+    }
+
+    // Get the index of the frame shown
+    int frame() const {
+        return current;
+    }
+
+    // Show a frame, restarting the timing from it if playing
+    void frame(int index) {
+        if (!frames || frames->count() == 0) return;
+        current = std::max(0, std::min(index, frames->count() - 1));
+        started = AnimationClock::now();
+        startFrame = current;
+        showFrame();
+    }
+
+    // Get the number of frames
+    int frameCount() const {
+        return source ? source->count() : 0;
+    }
+
+    // Get the frame rate
+    double fps() const {
+        return rate;
+    }
+
+    // Set the frame rate
+    void fps(double framesPerSecond) {
+        if (framesPerSecond <= 0) return;
+        started = AnimationClock::now();
+        startFrame = current;
+        rate = framesPerSecond;
+    }
+
+    // Get whether the animation starts over after the last frame
+    bool loop() const {
+        return looping;
+    }
+
+    // Set whether the animation starts over after the last frame
+    void loop(bool value) {
+        looping = value;
+    }
+
+    // Set the onFinish callback function, called when a non-looping animation reaches its last frame
+    void onFinish(std::function<void(bobcat::Widget *)> cb) {
+        CallbackTable::set(this, EVENT_FINISH, cb);
+    }
+
+    // Rescale the frames when the widget is resized
+    void resize(int x, int y, int w, int h) override {
+        bool sized = w != Fl_Box::w() || h != Fl_Box::h();
+        TextBox::resize(x, y, w, h);
+        if (sized) fit();
+    }
+
+    // Destructor to stop playback, the frames are released with the last widget using them
+    ~AnimatedImage() {
+        stop();
+        image(nullptr);
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef BOBCAT_UI_ASSET_BUNDLE
+#define BOBCAT_UI_ASSET_BUNDLE
+
+#include "bobcat_ui.h"
+#include <FL/Fl_PNG_Image.H>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace bobcat {
+
+// A file compiled into the program by tools/embed_assets
+struct Asset {
+    const char *name; // Path the file was embedded under, as passed to Image or TextureAtlas
+    const unsigned char *data; // File contents
+    size_t size; // Number of bytes in data
+};
+
+/**
+ * @class AssetBundle
+ * @brief Lookup of files compiled into the program.
+ *
+ * tools/embed_assets turns PNG files into a C++ source file whose assets
+ * register themselves here before main runs. ImageCache, and through it
+ * Image, as well as TextureAtlas, look a path up in the bundle before
+ * touching the filesystem, so bundled files are decoded straight from memory
+ * without a single open or stat call. Other code, such as the Window icon in
+ * window.cpp, can use loadPNG() for the same effect.
+ */
+class AssetBundle {
+    std::unordered_map<std::string, const Asset *> assets; // Registered assets by name
+    mutable std::mutex lock; // Guards assets, lookups may come from worker threads
+
+    // Drop a leading "./" so "./icon.png" and "icon.png" name the same asset
+    static std::string normalize(const std::string &path) {
+        if (path.compare(0, 2, "./") == 0) return path.substr(2);
+        return path;
+    }
+
+public:
+    // Get the bundle shared by the whole program
+    static AssetBundle &shared() {
+        static AssetBundle bundle;
+        return bundle;
+    }
+
+    // Register an array of assets, the array must outlive the bundle
+    void add(const Asset *list, size_t count) {
+        std::lock_guard<std::mutex> guard(lock);
+        for (size_t i = 0; i < count; i++) {
+            assets[normalize(list[i].name)] = &list[i];
+        }
+    }
+
+    // Get an asset by path, nullptr if it was not embedded
+    const Asset *find(const std::string &path) const {
+        std::lock_guard<std::mutex> guard(lock);
+        if (assets.empty()) return nullptr;
+        std::unordered_map<std::string, const Asset *>::const_iterator it = assets.find(normalize(path));
+        return it == assets.end() ? nullptr : it->second;
+    }
+
+    // Get the number of registered assets
+    size_t count() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return assets.size();
+    }
+
+    // Decode a PNG from the bundle, or from the file if it was not embedded, the caller owns the image
+    static Fl_PNG_Image *loadPNG(const std::string &path) {
+        const Asset *asset = shared().find(path);
+        if (asset) return new Fl_PNG_Image(path.c_str(), asset->data, (int)asset->size);
+        return new Fl_PNG_Image(path.c_str());
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+// Registers an array of assets with the shared bundle when constructed, used by generated files
+struct AssetRegistration {
+    AssetRegistration(const Asset *list, size_t count) {
+        AssetBundle::shared().add(list, count);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef BOBCAT_UI_CALLBACKS
+#define BOBCAT_UI_CALLBACKS
+
+#include "bobcat_ui.h"
+#include <FL/Fl_Widget.H>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace bobcat {
+
+// Events a widget callback can be registered for
+enum CALLBACK_EVENT {EVENT_CLICK, EVENT_ENTER, EVENT_LEAVE, EVENT_CHANGE, EVENT_SELECT, EVENT_FINISH};
+
+/**
+ * @class CallbackTable
+ * @brief Side table holding the std::function callbacks of every widget.
+ *
+ * Most widgets never get a callback, so instead of carrying one std::function
+ * member per event, widgets register the callbacks they are given here, keyed
+ * by widget address. A widget without callbacks costs nothing, and one with
+ * callbacks only pays for the events it uses. Widgets remove their entry when
+ * destroyed. Only used from the UI thread.
+ *
+ * Callbacks are called in place, without copying the std::function. While a
+ * callback runs, set() and clear() are queued and applied when the outermost
+ * callback returns, so a callback may replace itself or delete its widget.
+ */
+class CallbackTable {
+    typedef std::function<void(bobcat::Widget *)> Callback;
+    typedef std::vector<std::pair<CALLBACK_EVENT, Callback>> Slots;
+
+    // A set() or clear() made while a callback was running
+    struct Change {
+        const Fl_Widget *widget;
+        bool clear; // Remove every callback of the widget instead of setting one
+        CALLBACK_EVENT event;
+        Callback cb;
+    };
+
+    // Get the table of all widgets with at least one callback
+    static std::unordered_map<const Fl_Widget *, Slots> &table() {
+        static std::unordered_map<const Fl_Widget *, Slots> callbacks;
+        return callbacks;
+    }
+
+    // Get the number of callbacks running, nested ones included
+    static int &depth() {
+        static int running = 0;
+        return running;
+    }
+
+    // Get the changes waiting for the running callbacks to return
+    static std::vector<Change> &changes() {
+        static std::vector<Change> queued;
+        return queued;
+    }
+
+    // Marks a callback as running and applies the queued changes after the outermost one
+    struct Running {
+        Running() {
+            depth()++;
+        }
+
+        ~Running() {
+            if (--depth() > 0 || changes().empty()) return;
+            std::vector<Change> queued;
+            queued.swap(changes());
+            for (size_t i = 0; i < queued.size(); i++) {
+                if (queued[i].clear) {
+                    table().erase(queued[i].widget);
+                } else {
+                    store(queued[i].widget, queued[i].event, queued[i].cb);
+                }
+            }
+        }
+    };
+
+    // Check if a widget was cleared by a callback that is still running
+    static bool cleared(const Fl_Widget *widget) {
+        std::vector<Change> &queued = changes();
+        for (size_t i = 0; i < queued.size(); i++) {
+            if (queued[i].widget == widget && queued[i].clear) return true;
+        }
+        return false;
+    }
+
+    // Set or remove a callback in the table
+    static void store(const Fl_Widget *widget, CALLBACK_EVENT event, const Callback &cb) {
+        std::unordered_map<const Fl_Widget *, Slots> &callbacks = table();
+        std::unordered_map<const Fl_Widget *, Slots>::iterator it = callbacks.find(widget);
+        if (it == callbacks.end()) {
+            if (!cb) return;
+            it = callbacks.insert(std::make_pair(widget, Slots())).first;
+        }
+
+        Slots &slots = it->second;
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (slots[i].first != event) continue;
+            if (cb) {
+                slots[i].second = cb;
+            } else {
+                slots.erase(slots.begin() + i);
+                if (slots.empty()) callbacks.erase(it);
+            }
+            return;
+        }
+        if (cb) slots.push_back(std::make_pair(event, cb));
+    }
+
+public:
+    // Set the callback of a widget for an event, nullptr removes it
+    static void set(const Fl_Widget *widget, CALLBACK_EVENT event, Callback cb) {
+        if (depth() > 0) {
+            Change change = {widget, false, event, std::move(cb)};
+            changes().push_back(std::move(change));
+            return;
+        }
+        store(widget, event, cb);
+    }
+
+    // Check if a widget has a callback for an event, changes queued by a running callback are not seen yet
+    static bool has(const Fl_Widget *widget, CALLBACK_EVENT event) {
+        std::unordered_map<const Fl_Widget *, Slots> &callbacks = table();
+        if (callbacks.empty()) return false;
+        std::unordered_map<const Fl_Widget *, Slots>::const_iterator it = callbacks.find(widget);
+        if (it == callbacks.end()) return false;
+        for (size_t i = 0; i < it->second.size(); i++) {
+            if (it->second[i].first == event) return true;
+        }
+        return false;
+    }
+
+    // Get a copy of the callback of a widget for an event, empty if it has none
+    static Callback get(const Fl_Widget *widget, CALLBACK_EVENT event) {
+        std::unordered_map<const Fl_Widget *, Slots> &callbacks = table();
+        std::unordered_map<const Fl_Widget *, Slots>::const_iterator it = callbacks.find(widget);
+        if (it == callbacks.end()) return nullptr;
+        for (size_t i = 0; i < it->second.size(); i++) {
+            if (it->second[i].first == event) return it->second[i].second;
+        }
+        return nullptr;
+    }
+
+    // Call the callback of a widget for an event, if it has one
+    static void fire(bobcat::Widget *widget, CALLBACK_EVENT event) {
+        std::unordered_map<const Fl_Widget *, Slots> &callbacks = table();
+        if (callbacks.empty()) return;
+        std::unordered_map<const Fl_Widget *, Slots>::iterator it = callbacks.find(widget);
+        if (it == callbacks.end()) return;
+        if (depth() > 0 && !changes().empty() && cleared(widget)) return;
+        for (size_t i = 0; i < it->second.size(); i++) {
+            if (it->second[i].first != event) continue;
+            // The table keeps its shape until the callback returns, so the slot stays valid
+            Running running;
+            it->second[i].second(widget);
+            return;
+        }
+    }
+
+    // Remove every callback of a widget
+    static void clear(const Fl_Widget *widget) {
+        std::unordered_map<const Fl_Widget *, Slots> &callbacks = table();
+        if (callbacks.empty()) return;
+        if (depth() > 0) {
+            Change change = {widget, true, EVENT_CLICK, nullptr};
+            changes().push_back(std::move(change));
+            return;
+        }
+        callbacks.erase(widget);
+    }
+
+    // Get the number of widgets with at least one callback
+    static size_t widgets() {
+        return table().size();
+    }
+
+    // Get the approximate heap bytes used by the callbacks of a widget
+    static size_t bytes(const Fl_Widget *widget) {
+        std::unordered_map<const Fl_Widget *, Slots> &callbacks = table();
+        std::unordered_map<const Fl_Widget *, Slots>::const_iterator it = callbacks.find(widget);
+        if (it == callbacks.end()) return 0;
+        // Hash node with key and vector, bucket pointer, and the slot array
+        return sizeof(std::pair<const Fl_Widget *, Slots>) + 2 * sizeof(void *) + it->second.capacity() * sizeof(Slots::value_type);
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -0,0 +1,435 @@
+#ifndef BOBCAT_UI_COLLISION
+#define BOBCAT_UI_COLLISION
+
+#include "bobcat_ui.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace bobcat {
+
+// Shape types understood by the collision module
+enum SHAPE {SHAPE_CIRCLE, SHAPE_AABB, SHAPE_POLYGON};
+
+// Broad-phase strategies
+enum BROAD_PHASE {SWEEP_AND_PRUNE, UNIFORM_GRID};
+
+// A pair of overlapping bodies, a < b
+struct CollisionPair {
+    int a;
+    int b;
+};
+
+/**
+ * @class Bodies
+ * @brief Collision shapes stored as a structure of arrays.
+ *
+ * Every property lives in its own array indexed by body, so the loops of the
+ * broad phase read contiguous floats and can be vectorized by the compiler.
+ * Positions can be written directly through x and y between frames.
+ * Polygon vertices are stored relative to the body position and must
+ * describe a convex shape. Polygons with fewer than 3 vertices have no area
+ * and never collide.
+ */
+class Bodies {
+public:
+    std::vector<float> x, y; // Position (center of circles and boxes)
+    std::vector<unsigned char> shape; // SHAPE of every body
+    std::vector<float> radius; // Radius of circles
+    std::vector<float> halfW, halfH; // Half extents of boxes
+    std::vector<int> polyStart, polyCount; // Range of every polygon in polyX/polyY
+    std::vector<float> polyX, polyY; // Polygon vertices relative to the body position
+    std::vector<float> minX, minY, maxX, maxY; // Bounding boxes, filled by updateBounds()
+
+    // Get the number of bodies
+    int size() const {
+        return (int)x.size();
+    }
+
+    // Remove all bodies
+    void clear() {
+        x.clear(); y.clear(); shape.clear(); radius.clear(); halfW.clear(); halfH.clear();
+        polyStart.clear(); polyCount.clear(); polyX.clear(); polyY.clear();
+        minX.clear(); minY.clear(); maxX.clear(); maxY.clear();
+    }
+
+    // Add a circle, returns its index
+    int addCircle(float cx, float cy, float r) {
+        return add(SHAPE_CIRCLE, cx, cy, r, r, r, -1, 0);
+    }
+
+    // Add an axis aligned box given by its center and half extents, returns its index
+    int addBox(float cx, float cy, float hw, float hh) {
+        return add(SHAPE_AABB, cx, cy, 0, hw, hh, -1, 0);
+    }
+
+    // Add a convex polygon given as x0, y0, x1, y1, ... relative to (px, py), returns its index
+    int addPolygon(float px, float py, const std::vector<float> &points) {
+        int start = (int)polyX.size();
+        int count = (int)(points.size() / 2);
+        float ex = 0, ey = 0;
+        for (int i = 0; i < count; i++) {
+            polyX.push_back(points[2 * i]);
+            polyY.push_back(points[2 * i + 1]);
+            ex = std::max(ex, std::fabs(points[2 * i]));
+            ey = std::max(ey, std::fabs(points[2 * i + 1]));
+        }
+        // halfW/halfH hold the extent of the polygon around its position
+        return add(SHAPE_POLYGON, px, py, 0, ex, ey, start, count);
+    }
+
+    // Recompute the bounding boxes from the current positions
+    void updateBounds() {
+        int n = size();
+        minX.resize(n); minY.resize(n); maxX.resize(n); maxY.resize(n);
+        const float *px = x.data(), *py = y.data(), *hw = halfW.data(), *hh = halfH.data();
+        float *x0 = minX.data(), *y0 = minY.data(), *x1 = maxX.data(), *y1 = maxY.data();
+        // Circles and boxes both use their half extents, this loop vectorizes
+        for (int i = 0; i < n; i++) {
+            x0[i] = px[i] - hw[i];
+            x1[i] = px[i] + hw[i];
+            y0[i] = py[i] - hh[i];
+            y1[i] = py[i] + hh[i];
+        }
+        // Tighten polygon bounds to their actual vertices
+        for (int i = 0; i < n; i++) {
+            if (shape[i] != SHAPE_POLYGON || polyCount[i] == 0) continue;
+            float ax = 1e30f, ay = 1e30f, bx = -1e30f, by = -1e30f;
+            for (int k = polyStart[i]; k < polyStart[i] + polyCount[i]; k++) {
+                ax = std::min(ax, polyX[k]);
+                bx = std::max(bx, polyX[k]);
+                ay = std::min(ay, polyY[k]);
+                by = std::max(by, polyY[k]);
+            }
+            x0[i] = px[i] + ax;
+            x1[i] = px[i] + bx;
+            y0[i] = py[i] + ay;
+            y1[i] = py[i] + by;
+        }
+    }
+
+private:
+    // Append a body to every array
+    int add(SHAPE s, float cx, float cy, float r, float hw, float hh, int start, int count) {
+        x.push_back(cx);
+        y.push_back(cy);
+        shape.push_back((unsigned char)s);
+        radius.push_back(r);
+        halfW.push_back(hw);
+        halfH.push_back(hh);
+        polyStart.push_back(start);
+        polyCount.push_back(count);
+        return size() - 1;
+    }
+};
+
+/**
+ * @class CollisionDetector
+ * @brief Finds overlapping bodies with a broad phase followed by exact tests.
+ *
+ * The sweep-and-prune broad phase keeps its sort order between calls, so when
+ * bodies move a little each frame the order is repaired with an insertion sort
+ * in close to linear time. The uniform grid broad phase suits scenes where many
+ * bodies share the same x range; bodies covering too many cells are kept in a
+ * list that is tested against every body instead. Both hand their candidates
+ * to exact tests for circles, boxes and convex polygons.
+ */
+class CollisionDetector {
+    BROAD_PHASE method; // Broad phase in use
+    float cell; // Grid cell size, 0 picks one from the average body size
+    std::vector<int> order; // Bodies sorted by minX, kept between frames
+    std::vector<float> sMinX, sMaxX, sMinY, sMaxY; // Bounds in sort order
+    std::vector<CollisionPair> candidates; // Broad phase output
+    std::vector<uint64_t> cellKeys; // Grid cell of every (cell, body) entry
+    std::vector<int> cellBodies; // Body of every (cell, body) entry
+    std::vector<size_t> entryOrder; // Grid entries sorted by cell
+    std::vector<int> large; // Bodies covering too many cells to bucket
+    std::vector<unsigned char> isLarge; // Whether every body is in the large list
+
+    // Bodies covering more grid cells than this go in the large list
+    static const int maxCells = 64;
+
+    // Get the key of a grid cell
+    static uint64_t key(int cx, int cy) {
+        return ((uint64_t)(uint32_t)cy << 32) | (uint32_t)cx;
+    }
+
+    // Report a pair to the exact tests
+    void candidate(int p, int q) {
+        CollisionPair pair;
+        pair.a = std::min(p, q);
+        pair.b = std::max(p, q);
+        candidates.push_back(pair);
+    }
+
+    // Sweep along x and report pairs whose bounds overlap
+    void sweep(const Bodies &b) {
+        int n = b.size();
+        if ((int)order.size() != n) {
+            order.resize(n);
+            for (int i = 0; i < n; i++) order[i] = i;
+            std::sort(order.begin(), order.end(), [&](int p, int q) { return b.minX[p] < b.minX[q]; });
+        } else {
+            // Insertion sort is close to linear when the order barely changed
+            for (int i = 1; i < n; i++) {
+                int v = order[i];
+                float key = b.minX[v];
+                int j = i - 1;
+                while (j >= 0 && b.minX[order[j]] > key) {
+                    order[j + 1] = order[j];
+                    j--;
+                }
+                order[j + 1] = v;
+            }
+        }
+
+        sMinX.resize(n); sMaxX.resize(n); sMinY.resize(n); sMaxY.resize(n);
+        for (int i = 0; i < n; i++) {
+            int k = order[i];
+            sMinX[i] = b.minX[k];
+            sMaxX[i] = b.maxX[k];
+            sMinY[i] = b.minY[k];
+            sMaxY[i] = b.maxY[k];
+        }
+
+        for (int i = 0; i < n; i++) {
+            float right = sMaxX[i];
+            float top = sMaxY[i];
+            float bottom = sMinY[i];
+            for (int j = i + 1; j < n && sMinX[j] <= right; j++) {
+                if (sMinY[j] <= top && sMaxY[j] >= bottom) candidate(order[i], order[j]);
+            }
+        }
+    }
+
+    // Bucket bodies into grid cells and report pairs that share a cell
+    void grid(const Bodies &b) {
+        int n = b.size();
+        float size = cell;
+        if (size <= 0) {
+            double sum = 0;
+            for (int i = 0; i < n; i++) sum += (b.maxX[i] - b.minX[i]) + (b.maxY[i] - b.minY[i]);
+            size = n > 0 ? (float)(sum / n) : 1.0f;
+            if (size <= 0) size = 1.0f;
+        }
+        float inv = 1.0f / size;
+
+        cellKeys.clear();
+        cellBodies.clear();
+        large.clear();
+        isLarge.assign(n, 0);
+        for (int i = 0; i < n; i++) {
+            float fx0 = floorf(b.minX[i] * inv), fx1 = floorf(b.maxX[i] * inv);
+            float fy0 = floorf(b.minY[i] * inv), fy1 = floorf(b.maxY[i] * inv);
+            // Also catches cells outside the int range and NaN bounds
+            double covered = ((double)fx1 - fx0 + 1) * ((double)fy1 - fy0 + 1);
+            bool inRange = std::fabs(fx0) < 1e9f && std::fabs(fx1) < 1e9f && std::fabs(fy0) < 1e9f && std::fabs(fy1) < 1e9f;
+            if (!(covered <= maxCells) || !inRange) {
+                large.push_back(i);
+                isLarge[i] = 1;
+                continue;
+            }
+            for (int cy = (int)fy0; cy <= (int)fy1; cy++) {
+                for (int cx = (int)fx0; cx <= (int)fx1; cx++) {
+                    cellKeys.push_back(key(cx, cy));
+                    cellBodies.push_back(i);
+                }
+            }
+        }
+
+        entryOrder.resize(cellKeys.size());
+        for (size_t i = 0; i < entryOrder.size(); i++) entryOrder[i] = i;
+        std::sort(entryOrder.begin(), entryOrder.end(), [this](size_t p, size_t q) {
+            return cellKeys[p] < cellKeys[q];
+        });
+
+        size_t start = 0;
+        while (start < entryOrder.size()) {
+            uint64_t k = cellKeys[entryOrder[start]];
+            size_t end = start + 1;
+            while (end < entryOrder.size() && cellKeys[entryOrder[end]] == k) end++;
+            int cx = (int)(uint32_t)k;
+            int cy = (int)(uint32_t)(k >> 32);
+
+            for (size_t i = start; i < end; i++) {
+                int p = cellBodies[entryOrder[i]];
+                for (size_t j = i + 1; j < end; j++) {
+                    int q = cellBodies[entryOrder[j]];
+                    if (b.minX[q] > b.maxX[p] || b.maxX[q] < b.minX[p]) continue;
+                    if (b.minY[q] > b.maxY[p] || b.maxY[q] < b.minY[p]) continue;
+                    // Report the pair only from the cell holding the corner of the overlap
+                    float ox = std::max(b.minX[p], b.minX[q]);
+                    float oy = std::max(b.minY[p], b.minY[q]);
+                    if ((int)floorf(ox * inv) != cx || (int)floorf(oy * inv) != cy) continue;
+                    candidate(p, q);
+                }
+            }
+            start = end;
+        }
+
+        // Large bodies meet every body, a pair of large bodies is reported once
+        for (size_t i = 0; i < large.size(); i++) {
+            int p = large[i];
+            for (int q = 0; q < n; q++) {
+                if (q == p || (isLarge[q] && q < p)) continue;
+                if (b.minX[q] > b.maxX[p] || b.maxX[q] < b.minX[p]) continue;
+                if (b.minY[q] > b.maxY[p] || b.maxY[q] < b.minY[p]) continue;
+                candidate(p, q);
+            }
+        }
+    }
+
+    // Collect the corners of a box or polygon in world coordinates
+    static void corners(const Bodies &b, int i, std::vector<float> &out) {
+        out.clear();
+        if (b.shape[i] == SHAPE_AABB) {
+            float x0 = b.x[i] - b.halfW[i], x1 = b.x[i] + b.halfW[i];
+            float y0 = b.y[i] - b.halfH[i], y1 = b.y[i] + b.halfH[i];
+            const float pts[8] = {x0, y0, x1, y0, x1, y1, x0, y1};
+            out.assign(pts, pts + 8);
+            return;
+        }
+        for (int k = b.polyStart[i]; k < b.polyStart[i] + b.polyCount[i]; k++) {
+            out.push_back(b.x[i] + b.polyX[k]);
+            out.push_back(b.y[i] + b.polyY[k]);
+        }
+    }
+
+    // Project points onto an axis
+    static void project(const std::vector<float> &pts, float ax, float ay, float &lo, float &hi) {
+        lo = 1e30f;
+        hi = -1e30f;
+        for (size_t i = 0; i + 1 < pts.size(); i += 2) {
+            float d = pts[i] * ax + pts[i + 1] * ay;
+            lo = std::min(lo, d);
+            hi = std::max(hi, d);
+        }
+    }
+
+    // Check if the edge normals of p separate p from q
+    static bool separatedBy(const std::vector<float> &p, const std::vector<float> &q) {
+        size_t n = p.size() / 2;
+        for (size_t i = 0; i < n; i++) {
+            size_t j = (i + 1) % n;
+            float ax = -(p[2 * j + 1] - p[2 * i + 1]);
+            float ay = p[2 * j] - p[2 * i];
+            float p0, p1, q0, q1;
+            project(p, ax, ay, p0, p1);
+            project(q, ax, ay, q0, q1);
+            if (p1 < q0 || q1 < p0) return true;
+        }
+        return false;
+    }
+
+    // Separating axis test between a convex polygon and a circle
+    static bool polygonCircle(const std::vector<float> &p, float cx, float cy, float r) {
+        size_t n = p.size() / 2;
+        float best = 1e30f, bx = 0, by = 0;
+        for (size_t i = 0; i < n; i++) {
+            size_t j = (i + 1) % n;
+            float ax = -(p[2 * j + 1] - p[2 * i + 1]);
+            float ay = p[2 * j] - p[2 * i];
+            float len = sqrtf(ax * ax + ay * ay);
+            if (len == 0) continue;
+            ax /= len;
+            ay /= len;
+            float lo, hi;
+            project(p, ax, ay, lo, hi);
+            float c = cx * ax + cy * ay;
+            if (c + r < lo || c - r > hi) return false;
+            float dx = p[2 * i] - cx, dy = p[2 * i + 1] - cy;
+            float d = dx * dx + dy * dy;
+            if (d < best) {
+                best = d;
+                bx = p[2 * i];
+                by = p[2 * i + 1];
+            }
+        }
+        // The axis from the closest vertex to the center covers the corner regions
+        float ax = bx - cx, ay = by - cy;
+        float len = sqrtf(ax * ax + ay * ay);
+        if (len == 0) return true;
+        ax /= len;
+        ay /= len;
+        float lo, hi;
+        project(p, ax, ay, lo, hi);
+        float c = cx * ax + cy * ay;
+        return !(c + r < lo || c - r > hi);
+    }
+
+public:
+    // Constructor to choose the broad phase, a grid cell size of 0 is picked automatically
+    CollisionDetector(BROAD_PHASE method = SWEEP_AND_PRUNE, float cellSize = 0) {
+        this->method = method;
+        cell = cellSize;
+    }
+
+    // Change the broad phase
+    void broadPhase(BROAD_PHASE m, float cellSize = 0) {
+        method = m;
+        cell = cellSize;
+    }
+
+    // Exact overlap test between two bodies, bounds must be up to date
+    static bool overlaps(const Bodies &b, int i, int j) {
+        if ((b.shape[i] == SHAPE_POLYGON && b.polyCount[i] < 3) || (b.shape[j] == SHAPE_POLYGON && b.polyCount[j] < 3)) return false;
+        int si = b.shape[i], sj = b.shape[j];
+        if (si > sj) {
+            std::swap(i, j);
+            std::swap(si, sj);
+        }
+
+        if (si == SHAPE_CIRCLE && sj == SHAPE_CIRCLE) {
+            float dx = b.x[i] - b.x[j], dy = b.y[i] - b.y[j], r = b.radius[i] + b.radius[j];
+            return dx * dx + dy * dy <= r * r;
+        }
+        if (si == SHAPE_AABB && sj == SHAPE_AABB) {
+            return std::fabs(b.x[i] - b.x[j]) <= b.halfW[i] + b.halfW[j] &&
+                   std::fabs(b.y[i] - b.y[j]) <= b.halfH[i] + b.halfH[j];
+        }
+        if (si == SHAPE_CIRCLE && sj == SHAPE_AABB) {
+            float qx = std::max(b.minX[j], std::min(b.x[i], b.maxX[j]));
+            float qy = std::max(b.minY[j], std::min(b.y[i], b.maxY[j]));
+            float dx = b.x[i] - qx, dy = b.y[i] - qy;
+            return dx * dx + dy * dy <= b.radius[i] * b.radius[i];
+        }
+
+        // Scratch space reused between calls, so the polygon tests do not allocate
+        static thread_local std::vector<float> p, q;
+        corners(b, j, q);
+        if (si == SHAPE_CIRCLE) {
+            return polygonCircle(q, b.x[i], b.y[i], b.radius[i]);
+        }
+        corners(b, i, p);
+        return !separatedBy(p, q) && !separatedBy(q, p);
+    }
+
+    // Find all overlapping pairs, bounds are recomputed from the current positions
+    void detect(Bodies &b, std::vector<CollisionPair> &out) {
+        b.updateBounds();
+        candidates.clear();
+        if (method == UNIFORM_GRID) {
+            grid(b);
+        } else {
+            sweep(b);
+        }
+
+        out.clear();
+        for (size_t i = 0; i < candidates.size(); i++) {
+            if (overlaps(b, candidates[i].a, candidates[i].b)) out.push_back(candidates[i]);
+        }
+    }
+
+    // Get the number of pairs the last broad phase passed to the exact tests
+    int candidateCount() const {
+        return (int)candidates.size();
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -0,0 +1,326 @@
+#ifndef BOBCAT_UI_COMMAND_LIST
+#define BOBCAT_UI_COMMAND_LIST
+
+#include "bobcat_ui.h"
+#include "worker_pool.h"
+#include <GL/gl.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace bobcat {
+
+// Operations that can be recorded into a CommandList
+enum DRAW_OP {DRAW_COLOR, DRAW_LINE_WIDTH, DRAW_POINT_SIZE, DRAW_BEGIN, DRAW_VERTEX, DRAW_END};
+
+// A single recorded drawing command, in canvas coordinates (-1 to 1 on both axes)
+struct DrawCommand {
+    DRAW_OP op; // The operation
+    GLenum mode; // Primitive mode for DRAW_BEGIN
+    float a, b, c, d; // Arguments: r,g,b,a for colors, x,y for vertices, size for widths
+};
+
+/**
+ * @class CommandList
+ * @brief A list of drawing commands recorded away from the UI thread.
+ *
+ * A list mirrors the immediate mode calls used in Canvas_::render and adds
+ * helpers that tessellate shapes into triangles while recording, so that
+ * the expensive part of building geometry can run on worker threads. A list
+ * must only be recorded by one thread at a time and is replayed with
+ * execute() on the UI thread, inside render().
+ */
+class CommandList {
+    std::vector<DrawCommand> commands; // Recorded commands, kept allocated between frames
+
+    // Append a command
+    void push(DRAW_OP op, float a = 0, float b = 0, float c = 0, float d = 0, GLenum mode = 0) {
+        DrawCommand cmd;
+        cmd.op = op;
+        cmd.mode = mode;
+        cmd.a = a;
+        cmd.b = b;
+        cmd.c = c;
+        cmd.d = d;
+        commands.push_back(cmd);
+    }
+
+public:
+    // Remove all commands, keeping the storage for the next frame
+    void clear() {
+        commands.clear();
+    }
+
+    // Reserve room for a number of commands
+    void reserve(size_t count) {
+        commands.reserve(count);
+    }
+
+    // Get the number of recorded commands
+    size_t size() const {
+        return commands.size();
+    }
+
+    // Check if the list has no commands
+    bool empty() const {
+        return commands.empty();
+    }
+
+    // Get the recorded commands
+    const std::vector<DrawCommand> &data() const {
+        return commands;
+    }
+
+    // Set the current color
+    void color(float r, float g, float b, float a = 1.0f) {
+        push(DRAW_COLOR, r, g, b, a);
+    }
+
+    // Set the width of lines
+    void lineWidth(float width) {
+        push(DRAW_LINE_WIDTH, width);
+    }
+
+    // Set the size of points
+    void pointSize(float size) {
+        push(DRAW_POINT_SIZE, size);
+    }
+
+    // Start a primitive (GL_TRIANGLES, GL_LINES, GL_POLYGON, ...)
+    void begin(GLenum mode) {
+        push(DRAW_BEGIN, 0, 0, 0, 0, mode);
+    }
+
+    // Add a vertex to the current primitive
+    void vertex(float x, float y) {
+        push(DRAW_VERTEX, x, y);
+    }
+
+    // End the current primitive
+    void end() {
+        push(DRAW_END);
+    }
+
+    // Check if a bounding box touches the visible part of the canvas
+    static bool visible(float minX, float minY, float maxX, float maxY) {
+        return maxX >= -1.0f && minX <= 1.0f && maxY >= -1.0f && minY <= 1.0f;
+    }
+
+    // Record a filled rectangle with its top left corner at (x, y)
+    void fillRect(float x, float y, float w, float h) {
+        if (!visible(x, y - h, x + w, y)) return;
+        begin(GL_TRIANGLES);
+        vertex(x, y);         vertex(x + w, y);     vertex(x + w, y - h);
+        vertex(x, y);         vertex(x + w, y - h); vertex(x, y - h);
+        end();
+    }
+
+    // Record a filled circle, tessellated into triangles
+    void fillCircle(float cx, float cy, float r, int segments = 32) {
+        if (!visible(cx - r, cy - r, cx + r, cy + r)) return;
+        if (segments < 3) segments = 3;
+        float step = 2.0f * (float)M_PI / segments;
+        begin(GL_TRIANGLES);
+        float px = cx + r;
+        float py = cy;
+        for (int i = 1; i <= segments; i++) {
+            float nx = cx + r * cosf(step * i);
+            float ny = cy + r * sinf(step * i);
+            vertex(cx, cy);
+            vertex(px, py);
+            vertex(nx, ny);
+            px = nx;
+            py = ny;
+        }
+        end();
+    }
+
+    // Record a filled convex polygon given as x0, y0, x1, y1, ...
+    void fillPolygon(const std::vector<float> &points) {
+        size_t n = points.size() / 2;
+        if (n < 3) return;
+        float minX = points[0], maxX = points[0], minY = points[1], maxY = points[1];
+        for (size_t i = 1; i < n; i++) {
+            minX = std::min(minX, points[2 * i]);
+            maxX = std::max(maxX, points[2 * i]);
+            minY = std::min(minY, points[2 * i + 1]);
+            maxY = std::max(maxY, points[2 * i + 1]);
+        }
+        if (!visible(minX, minY, maxX, maxY)) return;
+        begin(GL_TRIANGLES);
+        for (size_t i = 1; i + 1 < n; i++) {
+            vertex(points[0], points[1]);
+            vertex(points[2 * i], points[2 * i + 1]);
+            vertex(points[2 * i + 2], points[2 * i + 3]);
+        }
+        end();
+    }
+
+    // Record a line segment
+    void line(float x1, float y1, float x2, float y2) {
+        if (!visible(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2))) return;
+        begin(GL_LINES);
+        vertex(x1, y1);
+        vertex(x2, y2);
+        end();
+    }
+
+    // Replay the commands through OpenGL, must be called on the UI thread from render()
+    void execute() const {
+        for (size_t i = 0; i < commands.size(); i++) {
+            const DrawCommand &cmd = commands[i];
+            switch (cmd.op) {
+                case DRAW_COLOR: glColor4f(cmd.a, cmd.b, cmd.c, cmd.d); break;
+                case DRAW_LINE_WIDTH: glLineWidth(cmd.a); break;
+                case DRAW_POINT_SIZE: glPointSize(cmd.a); break;
+                case DRAW_BEGIN: glBegin(cmd.mode); break;
+                case DRAW_VERTEX: glVertex2f(cmd.a, cmd.b); break;
+                case DRAW_END: glEnd(); break;
+            }
+        }
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+/**
+ * @class CommandListPool
+ * @brief Recycles CommandLists so that recording does not allocate every frame.
+ */
+class CommandListPool {
+    std::vector<CommandList *> freeLists; // Lists ready to be handed out
+    std::mutex lock; // Guards freeLists, acquire and release may be called from any thread
+
+public:
+    // Get an empty list, reusing a released one when possible
+    CommandList *acquire() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (!freeLists.empty()) {
+                CommandList *list = freeLists.back();
+                freeLists.pop_back();
+                return list;
+            }
+        }
+        return new CommandList();
+    }
+
+    // Give a list back to the pool
+    void release(CommandList *list) {
+        list->clear();
+        std::lock_guard<std::mutex> guard(lock);
+        freeLists.push_back(list);
+    }
+
+    // Destructor to delete the pooled lists
+    ~CommandListPool() {
+        for (size_t i = 0; i < freeLists.size(); i++) {
+            delete freeLists[i];
+        }
+    }
+};
+
+/**
+ * @class RenderQueue
+ * @brief Collects CommandLists from worker threads and submits them in order.
+ *
+ * Typical use inside a Canvas_ subclass:
+ *
+ *     void render() {
+ *         queue.record(8, [this](CommandList &list, int band) { buildBand(list, band); });
+ *         queue.submit();
+ *     }
+ *
+ * Lists are submitted sorted by their order key, and lists with the same key
+ * keep the order in which they were added.
+ */
+class RenderQueue {
+    struct Entry {
+        int order; // Submission order key
+        CommandList *list; // The recorded list
+    };
+
+    CommandListPool pool; // Source of the lists handed to recorders
+    std::vector<Entry> entries; // Lists waiting to be submitted
+    std::mutex lock; // Guards entries
+
+public:
+    // Get an empty list to record into
+    CommandList *acquire() {
+        return pool.acquire();
+    }
+
+    // Queue a recorded list for submission
+    void add(CommandList *list, int order = 0) {
+        std::lock_guard<std::mutex> guard(lock);
+        Entry entry;
+        entry.order = order;
+        entry.list = list;
+        entries.push_back(entry);
+    }
+
+    // Record `count` lists in parallel on the shared worker pool, list i gets order i
+    void record(int count, std::function<void(CommandList &, int)> recorder) {
+        std::vector<CommandList *> lists(count);
+        for (int i = 0; i < count; i++) {
+            lists[i] = pool.acquire();
+        }
+        WorkerPool::shared().parallelFor(count, [&](int i) {
+            recorder(*lists[i], i);
+        });
+        for (int i = 0; i < count; i++) {
+            add(lists[i], i);
+        }
+    }
+
+    // Take the queued lists in submission order, the caller must hand them back with recycle()
+    std::vector<CommandList *> take() {
+        std::vector<Entry> current;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            current.swap(entries);
+        }
+        std::stable_sort(current.begin(), current.end(), [](const Entry &a, const Entry &b) {
+            return a.order < b.order;
+        });
+        std::vector<CommandList *> result;
+        result.reserve(current.size());
+        for (size_t i = 0; i < current.size(); i++) {
+            result.push_back(current[i].list);
+        }
+        return result;
+    }
+
+    // Return lists obtained from take() to the pool
+    void recycle(const std::vector<CommandList *> &lists) {
+        for (size_t i = 0; i < lists.size(); i++) {
+            pool.release(lists[i]);
+        }
+    }
+
+    // Execute the queued lists through OpenGL and recycle them, must be called from render()
+    void submit() {
+        std::vector<CommandList *> lists = take();
+        for (size_t i = 0; i < lists.size(); i++) {
+            lists[i]->execute();
+        }
+        recycle(lists);
+    }
+
+    // Destructor to return the lists that were never submitted
+    ~RenderQueue() {
+        for (size_t i = 0; i < entries.size(); i++) {
+            delete entries[i].list;
+        }
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
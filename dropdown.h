@@ -2,12 +2,15 @@
 #define BOBCAT_UI_DROPDOWN
 
 #include "bobcat_ui.h"
+#include "callbacks.h"
+#include "label_pool.h"
 
 #include <FL/Enumerations.H>
 #include <FL/Fl_Choice.H>
 #include <FL/Fl_Widget.H>
 
 #include <string>
+#include <string_view>
 #include <functional>
 
 // #include <FL/names.h>
@@ -133,31 +136,17 @@ namespace bobcat {
 
 // Dropdown class inheriting from Fl_Choice
 class Dropdown: public Fl_Choice {
-    std::string caption; // Caption of the dropdown
-
-    // Callback functions for various events
-    std::function<void(bobcat::Widget *)> onEnterCb;
-    std::function<void(bobcat::Widget *)> onLeaveCb;
-    std::function<void(bobcat::Widget *)> onChangeCb;
-
-    // Initialize the callback functions to nullptr
-    void init() {
-        onEnterCb = nullptr;
-        onLeaveCb = nullptr;
-        onChangeCb = nullptr;
-    }
-
     // Handle events for the dropdown
     int handle(int event) {
         // if (event == 8 || event == 9)
         // printf("Event was %s (%d) - %s\n", fl_eventnames[event], event, value());
         int ret = Fl_Choice::handle(event);
         if (event == FL_ENTER) {
-            if (onEnterCb) onEnterCb(this);
+            CallbackTable::fire(this, EVENT_ENTER);
         }
 
         if (event == FL_LEAVE) {
-            if (onLeaveCb) onLeaveCb(this);
+            CallbackTable::fire(this, EVENT_LEAVE);
         }
 
         return ret;
@@ -166,21 +155,18 @@ class Dropdown: public Fl_Choice {
 public:
     // Constructor to initialize the dropdown with position, size, and caption
     Dropdown(int x, int y, int w, int h, std::string caption = ""): Fl_Choice(x, y, w, h, caption.c_str()) {
-        init();
         align(FL_ALIGN_TOP_LEFT);
-        this->caption = caption;
-        Fl_Choice::copy_label(caption.c_str());
+        LabelPool::assign(this, caption);
     }
 
     // Get the label of the dropdown
-    std::string label() const {
-        return caption;
+    std::string_view label() const {
+        return LabelPool::view(this);
     }
 
     // Set the label of the dropdown
-    void label(std::string s) {
-        Fl_Choice::copy_label(s.c_str());
-        caption = s;
+    void label(std::string_view s) {
+        LabelPool::assign(this, s);
     }
 
     // Get the text of the selected item
@@ -199,14 +185,14 @@ public:
     // Set the selected item by index
     void value(int index) {
         Fl_Choice::value(index);
-        if (onChangeCb) onChangeCb(this);
+        CallbackTable::fire(this, EVENT_CHANGE);
     }
 
     // Set the selected item by text
     void text(std::string s) {
         int i = Fl_Choice::find_index(s.c_str());
         Fl_Choice::value(i);
-        if (onChangeCb) onChangeCb(this);
+        CallbackTable::fire(this, EVENT_CHANGE);
     }
 
     // Get the index of the selected item
@@ -229,21 +215,21 @@ public:
 
     // Set the onEnter callback function
     void onEnter(std::function<void(bobcat::Widget *)> cb) {
-        onEnterCb = cb;
+        CallbackTable::set(this, EVENT_ENTER, cb);
     }
 
     // Set the onLeave callback function
     void onLeave(std::function<void(bobcat::Widget *)> cb) {
-        onLeaveCb = cb;
+        CallbackTable::set(this, EVENT_LEAVE, cb);
     }
 
     // Set the onChange callback function
     void onChange(std::function<void(bobcat::Widget *)> cb) {
-        onChangeCb = cb;
+        CallbackTable::set(this, EVENT_CHANGE, cb);
         when(FL_WHEN_CHANGED);
         callback([](bobcat::Widget* sender, void* self) {
             Dropdown *dd = (Dropdown*) self;
-            dd->onChangeCb(dd);
+            CallbackTable::fire(dd, EVENT_CHANGE);
         }, this);
     }
 
@@ -291,6 +277,12 @@ public:
         Fl_Choice::take_focus();
     }
 
+    // Destructor to remove the callbacks and release the label of the dropdown
+    ~Dropdown() {
+        CallbackTable::clear(this);
+        LabelPool::release(this);
+    }
+
     // Friend declaration for AppTest struct
     friend struct ::AppTest;
 };
@@ -0,0 +1,342 @@
+#ifndef BOBCAT_UI_FILTER
+#define BOBCAT_UI_FILTER
+
+#include "bobcat_ui.h"
+#include "pixel_buffer.h"
+#include "worker_pool.h"
+#include <FL/Fl.H>
+#include <FL/Fl_Image.H>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace bobcat {
+
+/**
+ * @class FilterPipeline
+ * @brief A chain of image filters applied in place to RGBA pixels.
+ *
+ * Filters are added in order with the builder functions. Runs of adjacent
+ * point filters (brightness, contrast, grayscale, colorMap and map) are
+ * compiled into lookup tables and applied in a single pass over the pixels,
+ * however long the run is. Blur is a separable three pass box blur whose
+ * sliding sums run four channels per SSE register. Every pass is split into
+ * bands on the shared WorkerPool. Alpha is left unchanged by point filters.
+ */
+class FilterPipeline {
+    // A run of point filters compiled into tables
+    struct PointPass {
+        unsigned char lut[3][256]; // Per channel tables applied first
+        bool cross; // A filter mixed the channels, outputs are functions of the luminance
+        unsigned char out[3][256]; // Luminance to channel tables, used when cross is set
+    };
+
+    // One step of the pipeline
+    struct Stage {
+        bool blur; // Blur stage, otherwise a point pass
+        int radius; // Blur radius in pixels
+        PointPass point; // Compiled point filters
+    };
+
+    std::vector<Stage> stages; // Steps in order
+
+    // Get the luminance of a color
+    static int luma(int r, int g, int b) {
+        return (77 * r + 150 * g + 29 * b + 128) >> 8;
+    }
+
+    // Get the point pass at the end of the pipeline, starting a new one if the last step is a blur
+    PointPass &lastPoint() {
+        if (stages.empty() || stages.back().blur) {
+            Stage s;
+            s.blur = false;
+            s.radius = 0;
+            for (int c = 0; c < 3; c++) {
+                for (int v = 0; v < 256; v++) s.point.lut[c][v] = (unsigned char)v;
+            }
+            s.point.cross = false;
+            stages.push_back(s);
+        }
+        return stages.back().point;
+    }
+
+    // Append a per channel mapping, folding it into the current point pass
+    void addChannelMap(const std::function<int(int channel, int value)> &f) {
+        PointPass &p = lastPoint();
+        unsigned char (*table)[256] = p.cross ? p.out : p.lut;
+        for (int c = 0; c < 3; c++) {
+            for (int v = 0; v < 256; v++) {
+                table[c][v] = (unsigned char)std::min(255, std::max(0, f(c, table[c][v])));
+            }
+        }
+    }
+
+    // Append a mapping from luminance to color, folding it into the current point pass
+    void addLumaMap(const std::function<void(int value, unsigned char rgb[3])> &f) {
+        PointPass &p = lastPoint();
+        unsigned char mapped[3][256];
+        for (int v = 0; v < 256; v++) {
+            // Before any cross filter the channels are independent, so the source is the luminance itself
+            int l = p.cross ? luma(p.out[0][v], p.out[1][v], p.out[2][v]) : v;
+            unsigned char rgb[3];
+            f(l, rgb);
+            for (int c = 0; c < 3; c++) mapped[c][v] = rgb[c];
+        }
+        for (int c = 0; c < 3; c++) {
+            for (int v = 0; v < 256; v++) p.out[c][v] = mapped[c][v];
+        }
+        p.cross = true;
+    }
+
+    // Run a point pass over a band of rows
+    static void runPoint(const PointPass &p, unsigned char *pixels, int w, int stride, int y0, int y1) {
+        for (int y = y0; y < y1; y++) {
+            unsigned char *px = pixels + (size_t)y * stride;
+            if (p.cross) {
+                for (int x = 0; x < w; x++, px += 4) {
+                    int l = luma(p.lut[0][px[0]], p.lut[1][px[1]], p.lut[2][px[2]]);
+                    px[0] = p.out[0][l];
+                    px[1] = p.out[1][l];
+                    px[2] = p.out[2][l];
+                }
+            } else {
+                for (int x = 0; x < w; x++, px += 4) {
+                    px[0] = p.lut[0][px[0]];
+                    px[1] = p.lut[1][px[1]];
+                    px[2] = p.lut[2][px[2]];
+                }
+            }
+        }
+    }
+
+    // Box blur one line of pixels with clamped edges, reading every step bytes from src
+    static void boxLine(const unsigned char *src, unsigned char *dst, int n, int step, int r) {
+        float scale = 1.0f / (2 * r + 1);
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        auto load = [&](int i) {
+            i = std::min(n - 1, std::max(0, i));
+            int raw;
+            memcpy(&raw, src + (size_t)i * step, 4);
+            return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(raw), zero), zero);
+        };
+        __m128i sum = _mm_setzero_si128();
+        for (int i = -r; i <= r; i++) sum = _mm_add_epi32(sum, load(i));
+        const __m128 mul = _mm_set1_ps(scale);
+        for (int i = 0; i < n; i++) {
+            __m128i v = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sum), mul));
+            v = _mm_packus_epi16(_mm_packs_epi32(v, zero), zero);
+            int out = _mm_cvtsi128_si32(v);
+            memcpy(dst + (size_t)i * step, &out, 4);
+            sum = _mm_add_epi32(sum, _mm_sub_epi32(load(i + r + 1), load(i - r)));
+        }
+#else
+        int sum[4] = {0, 0, 0, 0};
+        for (int i = -r; i <= r; i++) {
+            const unsigned char *p = src + (size_t)std::min(n - 1, std::max(0, i)) * step;
+            for (int c = 0; c < 4; c++) sum[c] += p[c];
+        }
+        for (int i = 0; i < n; i++) {
+            for (int c = 0; c < 4; c++) dst[(size_t)i * step + c] = (unsigned char)(sum[c] * scale + 0.5f);
+            const unsigned char *in = src + (size_t)std::min(n - 1, i + r + 1) * step;
+            const unsigned char *out = src + (size_t)std::max(0, i - r) * step;
+            for (int c = 0; c < 4; c++) sum[c] += in[c] - out[c];
+        }
+#endif
+    }
+
+    // Box blur a band of columns with clamped edges, sliding a sum over whole rows of bytes
+    static void boxColumns(const unsigned char *src, unsigned char *dst, int n, int bytes, int r) {
+        float scale = 1.0f / (2 * r + 1);
+        auto row = [&](int i) { return src + (size_t)std::min(n - 1, std::max(0, i)) * bytes; };
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 mul = _mm_set1_ps(scale);
+        auto load = [&](const unsigned char *p) {
+            int raw;
+            memcpy(&raw, p, 4);
+            return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(raw), zero), zero);
+        };
+        std::vector<int> totals(bytes, 0);
+        __m128i *sum = (__m128i *)totals.data();
+        for (int i = -r; i <= r; i++) {
+            const unsigned char *p = row(i);
+            for (int k = 0; k < bytes / 4; k++) _mm_storeu_si128(sum + k, _mm_add_epi32(_mm_loadu_si128(sum + k), load(p + 4 * k)));
+        }
+        for (int i = 0; i < n; i++) {
+            unsigned char *out = dst + (size_t)i * bytes;
+            const unsigned char *in = row(i + r + 1);
+            const unsigned char *gone = row(i - r);
+            for (int k = 0; k < bytes / 4; k++) {
+                __m128i total = _mm_loadu_si128(sum + k);
+                __m128i v = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(total), mul));
+                int px = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(v, zero), zero));
+                memcpy(out + 4 * k, &px, 4);
+                _mm_storeu_si128(sum + k, _mm_add_epi32(total, _mm_sub_epi32(load(in + 4 * k), load(gone + 4 * k))));
+            }
+        }
+#else
+        std::vector<int> sum(bytes, 0);
+        for (int i = -r; i <= r; i++) {
+            const unsigned char *p = row(i);
+            for (int k = 0; k < bytes; k++) sum[k] += p[k];
+        }
+        for (int i = 0; i < n; i++) {
+            unsigned char *out = dst + (size_t)i * bytes;
+            const unsigned char *in = row(i + r + 1);
+            const unsigned char *gone = row(i - r);
+            for (int k = 0; k < bytes; k++) {
+                out[k] = (unsigned char)(sum[k] * scale + 0.5f);
+                sum[k] += in[k] - gone[k];
+            }
+        }
+#endif
+    }
+
+    // Blur with three box passes in each direction, close to a Gaussian with sigma = radius
+    static void runBlur(int r, unsigned char *pixels, int w, int h, int stride) {
+        const int band = 32;
+        int rowBands = (h + band - 1) / band;
+        int colBands = (w + band - 1) / band;
+
+        WorkerPool::shared().parallelFor(rowBands, [&](int b) {
+            std::vector<unsigned char> line((size_t)w * 4);
+            for (int y = b * band; y < std::min(h, (b + 1) * band); y++) {
+                unsigned char *row = pixels + (size_t)y * stride;
+                for (int pass = 0; pass < 3; pass++) {
+                    boxLine(row, line.data(), w, 4, r);
+                    memcpy(row, line.data(), line.size());
+                }
+            }
+        });
+
+        // Columns are blurred a band at a time so every step reads whole rows of the band
+        WorkerPool::shared().parallelFor(colBands, [&](int b) {
+            int x0 = b * band;
+            int bytes = (std::min(w, x0 + band) - x0) * 4;
+            std::vector<unsigned char> a((size_t)h * bytes), c((size_t)h * bytes);
+            for (int y = 0; y < h; y++) memcpy(&a[(size_t)y * bytes], pixels + (size_t)y * stride + x0 * 4, bytes);
+            boxColumns(a.data(), c.data(), h, bytes, r);
+            boxColumns(c.data(), a.data(), h, bytes, r);
+            boxColumns(a.data(), c.data(), h, bytes, r);
+            for (int y = 0; y < h; y++) memcpy(pixels + (size_t)y * stride + x0 * 4, &c[(size_t)y * bytes], bytes);
+        });
+    }
+
+public:
+    // Add a brightness change, amount from -1 (black) to 1 (white)
+    FilterPipeline &brightness(float amount) {
+        int delta = (int)lroundf(amount * 255.0f);
+        addChannelMap([delta](int, int v) { return v + delta; });
+        return *this;
+    }
+
+    // Add a contrast change around mid gray, 1 keeps the image as is
+    FilterPipeline &contrast(float factor) {
+        addChannelMap([factor](int, int v) { return (int)lroundf((v - 127.5f) * factor + 127.5f); });
+        return *this;
+    }
+
+    // Add a conversion to grayscale
+    FilterPipeline &grayscale() {
+        addLumaMap([](int l, unsigned char rgb[3]) { rgb[0] = rgb[1] = rgb[2] = (unsigned char)l; });
+        return *this;
+    }
+
+    // Add a color map, the luminance of each pixel selects one of the colors, spread evenly from dark to light
+    FilterPipeline &colorMap(const std::vector<Fl_Color> &colors) {
+        if (colors.empty()) return *this;
+        std::vector<unsigned char> stops;
+        for (size_t i = 0; i < colors.size(); i++) {
+            unsigned char r, g, b;
+            Fl::get_color(colors[i], r, g, b);
+            stops.push_back(r);
+            stops.push_back(g);
+            stops.push_back(b);
+        }
+        size_t last = colors.size() - 1;
+        addLumaMap([stops, last](int l, unsigned char rgb[3]) {
+            float pos = l / 255.0f * last;
+            size_t i = std::min(last, (size_t)pos);
+            size_t j = std::min(last, i + 1);
+            float t = pos - i;
+            for (int c = 0; c < 3; c++) {
+                int a = stops[3 * i + c];
+                int b = stops[3 * j + c];
+                rgb[c] = (unsigned char)lroundf(a + (b - a) * t);
+            }
+        });
+        return *this;
+    }
+
+    // Add an arbitrary per channel mapping, channel is 0 to 2 for red, green and blue
+    FilterPipeline &map(std::function<int(int channel, int value)> f) {
+        addChannelMap(f);
+        return *this;
+    }
+
+    // Add a blur, radius is roughly the standard deviation in pixels
+    FilterPipeline &blur(int radius) {
+        if (radius <= 0) return *this;
+        Stage s;
+        s.blur = true;
+        s.radius = radius;
+        stages.push_back(s);
+        return *this;
+    }
+
+    // Remove every filter
+    void clear() {
+        stages.clear();
+    }
+
+    // Get the number of passes over the pixels, adjacent point filters count as one
+    int passes() const {
+        return (int)stages.size();
+    }
+
+    // Apply the filters to RGBA pixels in place, stride 0 means packed rows
+    void apply(unsigned char *rgba, int w, int h, int stride = 0) const {
+        if (!rgba || w <= 0 || h <= 0) return;
+        if (stride == 0) stride = w * 4;
+        const int band = 32;
+        int bands = (h + band - 1) / band;
+
+        for (size_t i = 0; i < stages.size(); i++) {
+            const Stage &s = stages[i];
+            if (s.blur) {
+                runBlur(s.radius, rgba, w, h, stride);
+            } else {
+                WorkerPool::shared().parallelFor(bands, [&](int b) {
+                    runPoint(s.point, rgba, w, stride, b * band, std::min(h, (b + 1) * band));
+                });
+            }
+        }
+    }
+
+    // Apply the filters to a buffer in place
+    void apply(PixelBuffer &pixels) const {
+        apply(pixels.rgba.data(), pixels.w, pixels.h);
+    }
+
+    // Create a filtered copy of an FLTK image, the caller owns it, nullptr if the image has no pixel data
+    Fl_RGB_Image *apply(const Fl_Image *img) const {
+        PixelBuffer pixels = PixelBuffer::fromImage(img);
+        if (pixels.empty()) return nullptr;
+        apply(pixels);
+        return pixels.toImage();
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
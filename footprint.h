@@ -0,0 +1,124 @@
+#ifndef BOBCAT_UI_FOOTPRINT
+#define BOBCAT_UI_FOOTPRINT
+
+#include "bobcat_ui.h"
+#include "callbacks.h"
+#include "label_pool.h"
+#include "dropdown.h"
+#include "group.h"
+#include "hexagon_button.h"
+#include "image.h"
+#include "input.h"
+#include "int_input.h"
+#include "list_box.h"
+#include "memo.h"
+#include "menu.h"
+#include "return_button.h"
+#include "textbox.h"
+#include <FL/Fl_Widget.H>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bobcat {
+
+// Size of one widget type, as reported by Footprint::types()
+struct WidgetFootprint {
+    std::string type; // Class name
+    size_t bytes; // sizeof the class
+    size_t legacyBytes; // sizeof the class with a caption member and one std::function member per event
+};
+
+/**
+ * @class Footprint
+ * @brief Memory report of the widget classes and of live widgets.
+ *
+ * Widgets used to keep their label in a std::string caption next to the copy
+ * FLTK makes, plus one std::function member per event. Labels now live once
+ * in the LabelPool and callbacks in the CallbackTable; this report compares
+ * both layouts. Button, CheckBox, FloatInput, Window and Canvas_ are declared
+ * without their implementation in this tree and still use the old layout.
+ */
+class Footprint {
+    typedef std::function<void(bobcat::Widget *)> Callback;
+
+    // Get the heap bytes of a std::string, libstdc++ keeps up to 15 characters inline
+    static size_t stringHeap(size_t length) {
+        return length <= 15 ? 0 : length + 1;
+    }
+
+    // Get a type's size with the members the old layout carried
+    template <class T>
+    static WidgetFootprint type(const char *name, int callbacks) {
+        WidgetFootprint f;
+        f.type = name;
+        f.bytes = sizeof(T);
+        f.legacyBytes = sizeof(T) + sizeof(std::string) + callbacks * sizeof(Callback);
+        return f;
+    }
+
+public:
+    // Get the size of every widget class with the compact layout, next to the old one
+    static std::vector<WidgetFootprint> types() {
+        std::vector<WidgetFootprint> all;
+        all.push_back(type<TextBox>("TextBox", 3));
+        all.push_back(type<Image>("Image", 3));
+        all.push_back(type<Input>("Input", 4));
+        all.push_back(type<IntInput>("IntInput", 4));
+        all.push_back(type<Memo>("Memo", 4));
+        all.push_back(type<Dropdown>("Dropdown", 3));
+        all.push_back(type<ListBox>("ListBox", 4));
+        all.push_back(type<ReturnButton>("ReturnButton", 3));
+        all.push_back(type<HexagonButton>("HexagonButton", 3));
+        all.push_back(type<Group>("Group", 3));
+        all.push_back(type<MenuItem>("MenuItem", 1));
+        return all;
+    }
+
+    // Get the heap bytes a live widget uses for its callbacks and its share of a pooled label
+    static size_t heap(const Fl_Widget *widget) {
+        const char *l = widget->label();
+        size_t label = l ? strlen(l) + 1 : 0;
+        size_t sharers = LabelPool::shared().refs(l);
+        if (sharers > 1) label /= sharers;
+        return label + CallbackTable::bytes(widget);
+    }
+
+    // Get the heap bytes the same widget used with a caption member, callbacks were stored inline
+    static size_t legacyHeap(const Fl_Widget *widget) {
+        const char *l = widget->label();
+        size_t length = l ? strlen(l) : 0;
+        return (l ? length + 1 : 0) + stringHeap(length);
+    }
+
+    // Print the class sizes, and the heap use of some live widgets if given
+    static void report(std::ostream &out, const std::vector<const Fl_Widget *> &widgets = std::vector<const Fl_Widget *>()) {
+        char line[128];
+        snprintf(line, sizeof(line), "%-16s %10s %10s\n", "Widget", "sizeof", "before");
+        out << line;
+        std::vector<WidgetFootprint> all = types();
+        for (size_t i = 0; i < all.size(); i++) {
+            snprintf(line, sizeof(line), "%-16s %10zu %10zu\n", all[i].type.c_str(), all[i].bytes, all[i].legacyBytes);
+            out << line;
+        }
+
+        if (widgets.empty()) return;
+        size_t now = 0, before = 0;
+        for (size_t i = 0; i < widgets.size(); i++) {
+            now += heap(widgets[i]);
+            before += legacyHeap(widgets[i]);
+        }
+        snprintf(line, sizeof(line), "Heap of %zu widgets: %zu bytes, %zu before, plus the heap of callback captures\n", widgets.size(), now, before);
+        out << line;
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -0,0 +1,497 @@
+#ifndef BOBCAT_UI_GALLERY
+#define BOBCAT_UI_GALLERY
+
+#include "bobcat_ui.h"
+#include "callbacks.h"
+#include "pixel_buffer.h"
+#include "png_writer.h"
+#include "resample.h"
+#include "worker_pool.h"
+#include <FL/Enumerations.H>
+#include <FL/Fl.H>
+#include <FL/Fl_Group.H>
+#include <FL/Fl_PNG_Image.H>
+#include <FL/Fl_Scrollbar.H>
+#include <FL/fl_draw.H>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bobcat {
+
+/**
+ * @class ThumbnailCache
+ * @brief Downscaled copies of images stored as PNG files in a cache directory.
+ *
+ * Thumbnails are keyed by a 64-bit FNV-1a hash of the file contents and the
+ * thumbnail size, so renamed or copied files share a thumbnail and edited
+ * files get a new one. All functions are safe to call from worker threads.
+ */
+class ThumbnailCache {
+    std::string dir; // Cache directory
+
+    // Create a directory and its parents
+    static void makeDirs(const std::string &path) {
+        for (size_t i = 1; i <= path.size(); i++) {
+            if (i == path.size() || path[i] == '/') {
+                mkdir(path.substr(0, i).c_str(), 0755);
+            }
+        }
+    }
+
+public:
+    // Constructor to set the cache directory, by default $XDG_CACHE_HOME/bobcat_ui/thumbnails
+    ThumbnailCache(std::string directory = "") {
+        dir = directory;
+        if (dir.empty()) {
+            const char *base = getenv("XDG_CACHE_HOME");
+            const char *home = getenv("HOME");
+            if (base && *base) {
+                dir = std::string(base) + "/bobcat_ui/thumbnails";
+            } else if (home && *home) {
+                dir = std::string(home) + "/.cache/bobcat_ui/thumbnails";
+            } else {
+                dir = "/tmp/bobcat_ui/thumbnails";
+            }
+        }
+    }
+
+    // Get the cache directory
+    std::string directory() const {
+        return dir;
+    }
+
+    // Get the FNV-1a hash of a file's contents, 0 if it cannot be read
+    static unsigned long long hashFile(const std::string &path) {
+        FILE *f = fopen(path.c_str(), "rb");
+        if (!f) return 0;
+        unsigned long long hash = 14695981039346656037ull;
+        unsigned char buffer[65536];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                hash ^= buffer[i];
+                hash *= 1099511628211ull;
+            }
+        }
+        fclose(f);
+        return hash;
+    }
+
+    // Get a thumbnail that fits a size x size box, decoding and storing it if it is not cached
+    // Returns an empty buffer if the image cannot be read
+    PixelBuffer load(const std::string &path, int size) {
+        unsigned long long hash = hashFile(path);
+        if (hash == 0) return PixelBuffer();
+
+        char name[64];
+        snprintf(name, sizeof(name), "/%016llx_%d.png", hash, size);
+        std::string cached = dir + name;
+
+        struct stat info;
+        if (stat(cached.c_str(), &info) == 0) {
+            Fl_PNG_Image thumb(cached.c_str());
+            PixelBuffer pixels = PixelBuffer::fromImage(&thumb);
+            if (!pixels.empty()) return pixels;
+        }
+
+        Fl_PNG_Image full(path.c_str());
+        PixelBuffer pixels = PixelBuffer::fromImage(&full);
+        if (pixels.empty()) return pixels;
+
+        double scale = std::min(1.0, std::min((double)size / pixels.w, (double)size / pixels.h));
+        int tw = std::max(1, (int)(pixels.w * scale + 0.5));
+        int th = std::max(1, (int)(pixels.h * scale + 0.5));
+        if (tw != pixels.w || th != pixels.h) pixels = Resampler::resize(pixels, tw, th, RESAMPLE_BICUBIC);
+
+        // Write to a temporary file first so readers never see a partial thumbnail
+        makeDirs(dir);
+        std::string temp = cached + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        if (PNGWriter::write(temp, pixels.rgba.data(), pixels.w, pixels.h, 4)) {
+            if (rename(temp.c_str(), cached.c_str()) != 0) remove(temp.c_str());
+        }
+        return pixels;
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+/**
+ * @class Gallery
+ * @brief A scrolling grid of image thumbnails.
+ *
+ * Items are laid out virtually: the gallery draws the cells itself and only
+ * keeps thumbnails for the rows on screen and a few pages around them.
+ * Thumbnails of visible items are produced on the shared WorkerPool through a
+ * ThumbnailCache, so reopening a folder reads small cached PNGs instead of
+ * decoding every full size image.
+ */
+class Gallery : public Fl_Group {
+    // One file in the gallery
+    struct Item {
+        std::string path; // Image file
+        std::string name; // File name shown under the thumbnail
+        Fl_RGB_Image *thumb; // Thumbnail, nullptr until loaded
+        bool loading; // A worker is producing the thumbnail
+        bool failed; // The file could not be read
+    };
+
+    // A thumbnail produced by a worker
+    struct Finished {
+        unsigned generation; // Item list the load was started for
+        int index; // Item index in that list
+        PixelBuffer thumb; // Thumbnail, empty if the file could not be read or the load was dropped
+    };
+
+    // State shared with the worker threads, which may outlive the widget
+    struct Loader {
+        std::mutex lock; // Guards finished
+        std::vector<Finished> finished; // Thumbnails waiting for the UI thread
+        std::atomic<unsigned> generation; // Bumped when the item list changes
+        std::atomic<bool> closed; // Set when the widget is destroyed
+
+        Loader() : generation(0), closed(false) {}
+    };
+
+    std::vector<Item> items; // Files in display order
+    std::shared_ptr<ThumbnailCache> cache; // Where thumbnails are stored
+    std::shared_ptr<Loader> loader; // Completion channel of the workers
+    Fl_Scrollbar *scrollbar; // Vertical scrollbar
+    int thumbSize; // Width and height of the thumbnail area of a cell
+    int scrollY; // Scroll offset in pixels
+    int selectedIndex; // Selected item, -1 if none
+    int inFlight; // Number of thumbnails being produced
+    int maxInFlight; // Number of thumbnails produced at the same time
+
+    static const int padding = 8; // Space around a cell
+    static const int captionH = 16; // Height of the file name under a thumbnail
+
+    // Get the size of a cell including its caption
+    int cellW() const {
+        return thumbSize + 2 * padding;
+    }
+
+    int cellH() const {
+        return thumbSize + 2 * padding + captionH;
+    }
+
+    // Get the width available to the cells
+    int gridW() const {
+        return w() - scrollbar->w();
+    }
+
+    // Get the number of cells per row
+    int columns() const {
+        return std::max(1, gridW() / cellW());
+    }
+
+    // Get the total height of the grid
+    int contentH() const {
+        int rows = ((int)items.size() + columns() - 1) / columns();
+        return rows * cellH();
+    }
+
+    // Get the range of items on screen, grown by margin rows
+    void visibleItems(int margin, int &first, int &last) const {
+        int row0 = std::max(0, scrollY / cellH() - margin);
+        int row1 = (scrollY + h()) / cellH() + margin;
+        first = std::min((int)items.size(), row0 * columns());
+        last = std::min((int)items.size(), (row1 + 1) * columns()) - 1;
+    }
+
+    // Update the scrollbar to the content height
+    void syncScrollbar() {
+        int maxY = std::max(0, contentH() - h());
+        scrollY = std::max(0, std::min(scrollY, maxY));
+        scrollbar->value(scrollY, h(), 0, std::max(h(), contentH()));
+        scrollbar->linesize(cellH() / 2);
+    }
+
+    static void onScroll(Fl_Widget *, void *data) {
+        Gallery *self = (Gallery *)data;
+        self->scrollY = self->scrollbar->value();
+        self->redraw();
+    }
+
+    // Start producing thumbnails for items on screen, then for the rows around them
+    void startLoads() {
+        int first, last;
+        visibleItems(0, first, last);
+        int aheadFirst, aheadLast;
+        visibleItems(2, aheadFirst, aheadLast);
+
+        std::vector<int> order;
+        for (int i = first; i <= last; i++) order.push_back(i);
+        for (int i = last + 1; i <= aheadLast; i++) order.push_back(i);
+        for (int i = first - 1; i >= aheadFirst; i--) order.push_back(i);
+
+        for (size_t k = 0; k < order.size() && inFlight < maxInFlight; k++) {
+            Item &item = items[order[k]];
+            if (item.thumb || item.loading || item.failed) continue;
+            item.loading = true;
+            inFlight++;
+
+            std::shared_ptr<Loader> channel = loader;
+            std::shared_ptr<ThumbnailCache> store = cache;
+            std::string path = item.path;
+            int index = order[k];
+            int size = thumbSize;
+            unsigned generation = loader->generation;
+            WorkerPool::shared().submit([channel, store, path, index, size, generation] {
+                Finished done;
+                done.generation = generation;
+                done.index = index;
+                if (!channel->closed && channel->generation == generation) done.thumb = store->load(path, size);
+                std::lock_guard<std::mutex> guard(channel->lock);
+                channel->finished.push_back(done);
+            });
+        }
+        if (inFlight > 0 && !Fl::has_timeout(pollLoads, this)) {
+            Fl::add_timeout(1.0 / 60, pollLoads, this);
+        }
+    }
+
+    // Move finished thumbnails into their items on the UI thread
+    // Loads started for an earlier item list only give back their slot
+    static void pollLoads(void *data) {
+        Gallery *self = (Gallery *)data;
+        std::vector<Finished> ready;
+        {
+            std::lock_guard<std::mutex> guard(self->loader->lock);
+            ready.swap(self->loader->finished);
+        }
+        for (size_t i = 0; i < ready.size(); i++) {
+            self->inFlight--;
+            int index = ready[i].index;
+            if (ready[i].generation != self->loader->generation || index < 0 || index >= (int)self->items.size()) continue;
+            Item &item = self->items[index];
+            item.loading = false;
+            if (ready[i].thumb.empty()) {
+                item.failed = true;
+            } else {
+                item.thumb = ready[i].thumb.toImage();
+            }
+        }
+        if (!ready.empty()) {
+            self->releaseFarThumbs();
+            self->redraw();
+        }
+        self->startLoads();
+        if (self->inFlight > 0) Fl::repeat_timeout(1.0 / 60, pollLoads, data);
+    }
+
+    // Delete thumbnails more than a few pages away from the view
+    void releaseFarThumbs() {
+        int pages = std::max(1, h() / cellH());
+        int first, last;
+        visibleItems(4 * pages, first, last);
+        for (int i = 0; i < (int)items.size(); i++) {
+            if ((i < first || i > last) && items[i].thumb) {
+                delete items[i].thumb;
+                items[i].thumb = nullptr;
+            }
+        }
+    }
+
+    // Delete every item and forget loads still running
+    void clearItems() {
+        loader->generation++;
+        for (size_t i = 0; i < items.size(); i++) {
+            delete items[i].thumb;
+        }
+        items.clear();
+        selectedIndex = -1;
+    }
+
+    // Get the item under a window position, -1 if none
+    int itemAt(int ex, int ey) const {
+        int cx = ex - x();
+        int cy = ey - y() + scrollY;
+        if (cx < 0 || cx >= columns() * cellW() || cy < 0) return -1;
+        int index = (cy / cellH()) * columns() + cx / cellW();
+        return index < (int)items.size() ? index : -1;
+    }
+
+public:
+    // Constructor to initialize the gallery with position, size, and thumbnail size
+    Gallery(int x, int y, int w, int h, int thumbnailSize = 128) : Fl_Group(x, y, w, h) {
+        thumbSize = thumbnailSize;
+        scrollY = 0;
+        selectedIndex = -1;
+        inFlight = 0;
+        maxInFlight = std::max(2, WorkerPool::shared().size() * 2);
+        cache = std::make_shared<ThumbnailCache>();
+        loader = std::make_shared<Loader>();
+
+        box(FL_FLAT_BOX);
+        color(FL_WHITE);
+        scrollbar = new Fl_Scrollbar(x + w - 16, y, 16, h);
+        scrollbar->callback(onScroll, this);
+        end();
+        resizable(nullptr);
+        syncScrollbar();
+    }
+
+    // Show the PNG files of a directory, sorted by name
+    void open(std::string directory) {
+        std::vector<std::string> files;
+        DIR *d = opendir(directory.c_str());
+        if (d) {
+            while (dirent *entry = readdir(d)) {
+                std::string name = entry->d_name;
+                if (name.size() > 4) {
+                    std::string ext = name.substr(name.size() - 4);
+                    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+                    if (ext == ".png") files.push_back(directory + "/" + name);
+                }
+            }
+            closedir(d);
+        }
+        std::sort(files.begin(), files.end());
+        setItems(files);
+    }
+
+    // Show a list of PNG files
+    void setItems(const std::vector<std::string> &paths) {
+        clearItems();
+        for (size_t i = 0; i < paths.size(); i++) {
+            Item item;
+            item.path = paths[i];
+            size_t slash = paths[i].find_last_of('/');
+            item.name = slash == std::string::npos ? paths[i] : paths[i].substr(slash + 1);
+            item.thumb = nullptr;
+            item.loading = false;
+            item.failed = false;
+            items.push_back(item);
+        }
+        scrollY = 0;
+        syncScrollbar();
+        redraw();
+    }
+
+    // Set the directory thumbnails are stored in
+    void cacheDirectory(std::string directory) {
+        cache = std::make_shared<ThumbnailCache>(directory);
+    }
+
+    // Get the number of items
+    int count() const {
+        return (int)items.size();
+    }
+
+    // Get the file of an item
+    std::string path(int index) const {
+        return items[index].path;
+    }
+
+    // Get the selected item, -1 if none
+    int selected() const {
+        return selectedIndex;
+    }
+
+    // Select an item and scroll it into view
+    void select(int index) {
+        selectedIndex = index < 0 || index >= (int)items.size() ? -1 : index;
+        if (selectedIndex >= 0) {
+            int top = (selectedIndex / columns()) * cellH();
+            if (top < scrollY) scrollY = top;
+            if (top + cellH() > scrollY + h()) scrollY = top + cellH() - h();
+            syncScrollbar();
+        }
+        redraw();
+    }
+
+    // Set the onSelect callback function
+    void onSelect(std::function<void(bobcat::Widget *)> cb) {
+        CallbackTable::set(this, EVENT_SELECT, cb);
+    }
+
+    // Draw the cells on screen and request their thumbnails
+    void draw() override {
+        syncScrollbar();
+        draw_box();
+        fl_push_clip(x(), y(), gridW(), h());
+
+        int first, last;
+        visibleItems(0, first, last);
+        fl_font(FL_HELVETICA, 12);
+        for (int i = first; i <= last; i++) {
+            int cx = x() + (i % columns()) * cellW();
+            int cy = y() + (i / columns()) * cellH() - scrollY;
+            if (i == selectedIndex) {
+                fl_color(FL_SELECTION_COLOR);
+                fl_rectf(cx + 2, cy + 2, cellW() - 4, cellH() - 4);
+            }
+
+            Item &item = items[i];
+            if (item.thumb) {
+                int tx = cx + padding + (thumbSize - item.thumb->w()) / 2;
+                int ty = cy + padding + (thumbSize - item.thumb->h()) / 2;
+                item.thumb->draw(tx, ty);
+            } else {
+                fl_color(FL_LIGHT2);
+                fl_rectf(cx + padding, cy + padding, thumbSize, thumbSize);
+            }
+
+            fl_color(i == selectedIndex ? FL_WHITE : FL_BLACK);
+            fl_push_clip(cx + 2, cy, cellW() - 4, cellH());
+            fl_draw(item.name.c_str(), cx + 2, cy + padding + thumbSize, cellW() - 4, cellH() - thumbSize - padding, FL_ALIGN_CENTER | FL_ALIGN_CLIP);
+            fl_pop_clip();
+        }
+
+        fl_pop_clip();
+        draw_child(*scrollbar);
+        startLoads();
+    }
+
+    // Handle selection and mouse wheel scrolling
+    int handle(int event) override {
+        if (event == FL_MOUSEWHEEL) {
+            scrollY += Fl::event_dy() * cellH() / 2;
+            syncScrollbar();
+            redraw();
+            return 1;
+        }
+        if (event == FL_PUSH && !Fl::event_inside(scrollbar)) {
+            int index = itemAt(Fl::event_x(), Fl::event_y());
+            if (index >= 0) {
+                select(index);
+                CallbackTable::fire(this, EVENT_SELECT);
+            }
+            return 1;
+        }
+        return Fl_Group::handle(event);
+    }
+
+    // Keep the scrollbar on the right edge and the thumbnails in range
+    void resize(int x, int y, int w, int h) override {
+        Fl_Widget::resize(x, y, w, h);
+        scrollbar->resize(x + w - scrollbar->w(), y, scrollbar->w(), h);
+        syncScrollbar();
+    }
+
+    // Destructor to stop the loads, remove the callbacks and delete the thumbnails
+    ~Gallery() {
+        CallbackTable::clear(this);
+        loader->closed = true;
+        Fl::remove_timeout(pollLoads, this);
+        clearItems();
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
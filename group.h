@@ -2,12 +2,21 @@
 #define BOBCAT_UI_GROUP
 
 #include "bobcat_ui.h"
+#include "callbacks.h"
+#include "label_pool.h"
+#include "layout.h"
+#include "spatial_index.h"
+#include "widget_arena.h"
 #include <FL/Enumerations.H>
+#include <FL/Fl.H>
 #include <FL/Fl_Gl_Window.H>
 #include <FL/Fl_PNG_Image.H>
 #include <GL/gl.h>
 #include <string>
+#include <string_view>
 #include <functional>
+#include <memory>
+#include <utility>
 
 namespace bobcat {
 
@@ -19,54 +28,178 @@ namespace bobcat {
  * additional callback functions for various events such as change, enter, and leave.
  */
 class Group : public Fl_Group {
-private:
-    std::string caption; // Caption of the group
+    std::unique_ptr<WidgetArena> arena; // Storage of children made with emplace, created on first use
 
-    // Initialize the callback functions to nullptr
-    void init() {
-        onChangeCb = nullptr;
-        onEnterCb = nullptr;
-        onLeaveCb = nullptr;
+    // Builder of a lazy group, see lazy()
+    struct LazyState {
+        std::function<void(bobcat::Group *)> builder; // Creates the children
+        double unloadAfter; // Seconds hidden before the children are destroyed, 0 keeps them
+        bool built; // The children exist
+    };
+
+    std::unique_ptr<LazyState> lazyState; // Set for lazy groups only
+    std::unique_ptr<Layout> layoutState; // Places the children, see layout()
+    std::unique_ptr<SpatialIndex> spatial; // Finds the child under the pointer, see indexChildren()
+
+    // Run the builder of a lazy group if its children do not exist
+    void build() {
+        if (!lazyState || lazyState->built) return;
+        lazyState->built = true;
+        Fl::remove_timeout(unload, this);
+        Fl_Group *current = Fl_Group::current();
+        begin();
+        lazyState->builder(this);
+        end();
+        Fl_Group::current(current);
+        redraw();
+    }
+
+    // Destroy the children of a lazy group that is still hidden
+    static void unload(void *data) {
+        Group *self = (Group *)data;
+        if (!self->lazyState || !self->lazyState->built || self->visible_r()) return;
+        if (self->layoutState) self->layoutState->clear();
+        if (self->arena) self->arena->clear();
+        self->clear();
+        self->lazyState->built = false;
     }
 
 protected:
-    // Callback functions for various events
-    std::function<void(bobcat::Widget *)> onChangeCb;
-    std::function<void(bobcat::Widget *)> onEnterCb;
-    std::function<void(bobcat::Widget *)> onLeaveCb;
+    // Get the callback functions set with onChange, onEnter and onLeave, empty if not set
+    std::function<void(bobcat::Widget *)> onChangeCb() const {
+        return CallbackTable::get(this, EVENT_CHANGE);
+    }
+
+    std::function<void(bobcat::Widget *)> onEnterCb() const {
+        return CallbackTable::get(this, EVENT_ENTER);
+    }
+
+    std::function<void(bobcat::Widget *)> onLeaveCb() const {
+        return CallbackTable::get(this, EVENT_LEAVE);
+    }
 
 public:
     // Constructor to initialize the group with position, size, and title
     Group(int x, int y, int w, int h, std::string title = "") : Fl_Group(x, y, w, h, title.c_str()) { 
-        init();
-        caption = title;
-        Fl_Widget::copy_label(caption.c_str());
+        LabelPool::assign(this, title);
     }
 
     // Set the onChange callback function
     void onChange(std::function<void(bobcat::Widget *)> cb) {
-        onChangeCb = cb;
+        CallbackTable::set(this, EVENT_CHANGE, cb);
     }
 
     // Set the onEnter callback function
     void onEnter(std::function<void(bobcat::Widget *)> cb) {
-        onEnterCb = cb;
+        CallbackTable::set(this, EVENT_ENTER, cb);
     }
 
     // Set the onLeave callback function
     void onLeave(std::function<void(bobcat::Widget *)> cb) {
-        onLeaveCb = cb;
+        CallbackTable::set(this, EVENT_LEAVE, cb);
     }
 
     // Get the label of the group
-    std::string label() const {
-        return caption;
+    std::string_view label() const {
+        return LabelPool::view(this);
     }
 
     // Set the label of the group
-    void label(std::string s) {
-        Fl_Widget::copy_label(s.c_str());
-        caption = s;
+    void label(std::string_view s) {
+        LabelPool::assign(this, s);
+    }
+
+    // Construct a child in the group's arena, it is destroyed with the group and must never be deleted
+    template <class T, class... Args>
+    T *emplace(Args &&... args) {
+        return emplaceInto<T>(this, std::forward<Args>(args)...);
+    }
+
+    // Construct a widget in the group's arena and add it to parent, a group inside this one that lives as long as it
+    template <class T, class... Args>
+    T *emplaceInto(Fl_Group *parent, Args &&... args) {
+        if (!arena) arena.reset(new WidgetArena());
+        return arena->create<T>(parent, std::forward<Args>(args)...);
+    }
+
+    // Get the number of widgets in the group's arena
+    size_t arenaCount() const {
+        return arena ? arena->count() : 0;
+    }
+
+    // Create the children with a builder on the first show instead of now, the builder should make all of them
+    // If unloadAfter is positive, the children are destroyed again once the group
+    // has been hidden for that many seconds and rebuilt on the next show
+    // Unloading empties the group's layout, so a builder must add what it makes to layout() each time
+    void lazy(std::function<void(bobcat::Group *)> builder, double unloadAfter = 0) {
+        lazyState.reset(new LazyState());
+        lazyState->builder = builder;
+        lazyState->unloadAfter = unloadAfter;
+        lazyState->built = false;
+        if (visible_r()) build();
+    }
+
+    // Check if the children of a lazy group exist, always true for other groups
+    bool built() const {
+        return !lazyState || lazyState->built;
+    }
+
+    // Place the children with a new row, column or grid layout and return it
+    Layout &layout(LAYOUT_KIND kind, int gap = 0, int margin = 0) {
+        layoutState.reset();
+        layoutState.reset(new Layout(this, kind, gap, margin));
+        return *layoutState;
+    }
+
+    // Get the layout of the group, or null if the children are placed by hand
+    Layout *layout() const {
+        return layoutState.get();
+    }
+
+    // Find the child under the pointer through a grid index instead of testing every child
+    // Worth it for groups with hundreds of children, cellSize is about the size of a child
+    void indexChildren(int cellSize = 64) {
+        spatial.reset();
+        spatial.reset(new SpatialIndex(this, cellSize));
+    }
+
+    // Check if the group indexes its children
+    bool indexed() const {
+        return spatial != nullptr;
+    }
+
+    // Build a lazy group when it becomes visible and schedule unloading when it is hidden
+    // Pointer events go through the child index if there is one
+    int handle(int event) override {
+        if (event == FL_SHOW) build();
+        if (event == FL_HIDE && lazyState && lazyState->built && lazyState->unloadAfter > 0) {
+            Fl::remove_timeout(unload, this);
+            Fl::add_timeout(lazyState->unloadAfter, unload, this);
+        }
+        if (spatial) {
+            int routed = spatial->route(event);
+            if (routed >= 0) return routed;
+        }
+        return Fl_Group::handle(event);
+    }
+
+    // Build a lazy group that is drawn without having received FL_SHOW
+    // and run a layout whose constraints changed since the last resize
+    void draw() override {
+        build();
+        if (layoutState) layoutState->apply();
+        Fl_Group::draw();
+    }
+
+    // Resize the group, a layout places the children instead of FLTK scaling them
+    void resize(int x, int y, int w, int h) override {
+        if (!layoutState) {
+            Fl_Group::resize(x, y, w, h);
+            if (spatial) spatial->invalidate();
+            return;
+        }
+        Fl_Widget::resize(x, y, w, h);
+        layoutState->apply();
     }
 
     // void show() override {
@@ -75,6 +208,17 @@ public:
     //     Fl::flush();                // Make sure to draw what needs to be drawn
     // }
 
+    // Destructor to remove the callbacks and release the label of the group
+    // Arena children are destroyed here, before Fl_Group deletes the remaining ones
+    ~Group() {
+        CallbackTable::clear(this);
+        LabelPool::release(this);
+        Fl::remove_timeout(unload, this);
+        spatial.reset();
+        layoutState.reset();
+        arena.reset();
+    }
+
     friend struct ::AppTest;
 };
 
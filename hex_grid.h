@@ -0,0 +1,222 @@
+#ifndef BOBCAT_UI_HEX_GRID
+#define BOBCAT_UI_HEX_GRID
+
+#include "group.h"
+#include "hexagon_button.h"
+#include <FL/Enumerations.H>
+#include <FL/Fl.H>
+#include <FL/Fl_Widget.H>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bobcat {
+
+/**
+ * @class HexGrid
+ * @brief A board of HexagonButtons addressed by axial coordinates.
+ *
+ * Cells are flat-topped hexagons whose flat edges touch the top and bottom
+ * of the cell size, so neighbors share edges without gaps. Cell (q, r) sits
+ * q columns to the right, each column shifted down by half a cell, and r
+ * cells down. A cell deleted another way than removeCell, such as by clear()
+ * or by unloading a lazy grid, takes itself out of the grid. Cells are kept
+ * in a hash map by coordinate, so finding the cell at a coordinate or under
+ * the pointer takes the same time on any board size, and pointer events go
+ * straight to that cell instead of through every child. Other children are
+ * reached the usual way when no cell is under the pointer.
+ */
+class HexGrid : public Group {
+    // A hexagon filling its box from top to bottom, unlike the regular HexagonButton
+    class Cell : public HexagonButton {
+    public:
+        HexGrid *grid; // Grid whose map holds the cell, null once the grid is destroyed
+        int q, r; // Coordinate of the cell
+
+        Cell(HexGrid *grid, int q, int r, int x, int y, int w, int h, std::string caption) : HexagonButton(x, y, w, h, tile(), caption) {
+            this->grid = grid;
+            this->q = q;
+            this->r = r;
+        }
+
+        // Get the outline shared by every cell
+        static std::shared_ptr<const std::vector<PolygonVertex>> tile() {
+            static std::shared_ptr<const std::vector<PolygonVertex>> table = std::make_shared<const std::vector<PolygonVertex>>(
+                std::vector<PolygonVertex>{{1, 0}, {0.5, 1}, {-0.5, 1}, {-1, 0}, {-0.5, -1}, {0.5, -1}});
+            return table;
+        }
+
+        // Destructor to take the cell out of the grid's map
+        ~Cell() {
+            if (grid) grid->forget(q, r, this);
+        }
+    };
+
+    // A cell with its index among the children when last checked
+    struct Slot {
+        Cell *cell;
+        mutable int z;
+    };
+
+    int cellW; // Width of a cell
+    int cellH; // Height of a cell
+    std::unordered_map<uint64_t, Slot> cells; // Cells by coordinate, including ones removed from the children
+
+    // Get the map key of a coordinate
+    static uint64_t key(int q, int r) {
+        return ((uint64_t)(uint32_t)q << 32) | (uint32_t)r;
+    }
+
+    // Check if a cell is still a child, a cell taken out with Fl_Group::remove stays in the map
+    bool alive(const Slot &slot) const {
+        if (slot.z >= children() || child(slot.z) != slot.cell) slot.z = find(slot.cell);
+        return slot.z < children();
+    }
+
+    // Take a deleted cell out of the map, unless another cell has its coordinate by now
+    void forget(int q, int r, const Cell *cell) {
+        std::unordered_map<uint64_t, Slot>::iterator it = cells.find(key(q, r));
+        if (it != cells.end() && it->second.cell == cell) cells.erase(it);
+    }
+
+    // Get the left edge of the cells in column q
+    int cellX(int q) const {
+        return x() + (int)std::lround(q * 0.75 * cellW);
+    }
+
+    // Get the top edge of cell (q, r)
+    int cellY(int q, int r) const {
+        return y() + (int)std::lround((r + q / 2.0) * cellH);
+    }
+
+    // Send a pointer event to one cell the way Fl_Group sends it to the child under the pointer
+    int route(Fl_Widget *o, int event) {
+        if (event == FL_PUSH) {
+            if (!o->takesevents()) return 0;
+            Fl_Widget_Tracker wp(o);
+            if (o->handle(FL_PUSH)) {
+                if (Fl::pushed() && wp.exists() && !o->contains(Fl::pushed())) Fl::pushed(o);
+                return 1;
+            }
+            return wp.deleted() ? 1 : 0;
+        }
+        if (o->contains(Fl::belowmouse())) return o->handle(FL_MOVE);
+        Fl::belowmouse(o);
+        if (o->handle(FL_ENTER)) return 1;
+        Fl::belowmouse(this);
+        return 1;
+    }
+
+public:
+    // Constructor to initialize the grid with position, size, and the size of a cell
+    // A regular hexagon is about 0.87 times as high as it is wide
+    HexGrid(int x, int y, int w, int h, int cellW = 64, int cellH = 56) : Group(x, y, w, h) {
+        this->cellW = cellW;
+        this->cellH = cellH;
+        end();
+    }
+
+    // Add a cell at (q, r), replacing the cell already there
+    HexagonButton *addCell(int q, int r, std::string caption = "") {
+        removeCell(q, r);
+        Cell *cell = new Cell(this, q, r, cellX(q), cellY(q, r), cellW, cellH, caption);
+        Group::add(cell);
+        Slot slot;
+        slot.cell = cell;
+        slot.z = children() - 1;
+        cells[key(q, r)] = slot;
+        redraw();
+        return cell;
+    }
+
+    // Delete the cell at (q, r)
+    void removeCell(int q, int r) {
+        std::unordered_map<uint64_t, Slot>::iterator it = cells.find(key(q, r));
+        if (it == cells.end()) return;
+        Slot slot = it->second;
+        cells.erase(it);
+        // Deleted cells leave the map themselves, so this one exists; if it was taken out, its owner deletes it
+        if (!alive(slot)) {
+            slot.cell->grid = nullptr;
+            return;
+        }
+        Group::remove(slot.cell);
+        delete slot.cell;
+        redraw();
+    }
+
+    // Get the cell at (q, r), or null
+    HexagonButton *at(int q, int r) const {
+        std::unordered_map<uint64_t, Slot>::const_iterator it = cells.find(key(q, r));
+        return it == cells.end() || !alive(it->second) ? nullptr : it->second.cell;
+    }
+
+    // Get the number of cells
+    size_t count() const {
+        size_t n = 0;
+        for (std::unordered_map<uint64_t, Slot>::const_iterator it = cells.begin(); it != cells.end(); ++it) {
+            if (alive(it->second)) n++;
+        }
+        return n;
+    }
+
+    // Find the coordinate of the cell whose hexagon contains a window point
+    bool cellAt(int px, int py, int &q, int &r) {
+        // Fractional axial coordinate of the point, then round to the nearest hexagon center
+        double fq = (px - x() - cellW / 2.0) / (0.75 * cellW);
+        double fr = (py - y() - cellH / 2.0) / cellH - fq / 2;
+        double fs = -fq - fr;
+        double rq = std::round(fq), rr = std::round(fr), rs = std::round(fs);
+        double dq = std::fabs(rq - fq), dr = std::fabs(rr - fr), ds = std::fabs(rs - fs);
+        if (dq > dr && dq > ds) {
+            rq = -rr - rs;
+        } else if (dr > ds) {
+            rr = -rq - rs;
+        }
+
+        // Outlines are rounded to pixels, so a point on an edge may belong to a neighbor
+        static const int around[7][2] = {{0, 0}, {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, -1}, {-1, 1}};
+        for (int i = 0; i < 7; i++) {
+            int cq = (int)rq + around[i][0], cr = (int)rr + around[i][1];
+            HexagonButton *cell = at(cq, cr);
+            if (cell && cell->visible() && cell->inside(px, py)) {
+                q = cq;
+                r = cr;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Get the cell whose hexagon contains a window point, or null
+    HexagonButton *cellAt(int px, int py) {
+        int q, r;
+        return cellAt(px, py, q, r) ? at(q, r) : nullptr;
+    }
+
+    // Route pointer events to the cell under the pointer
+    int handle(int event) override {
+        if (event == FL_PUSH || event == FL_MOVE || event == FL_ENTER) {
+            HexagonButton *cell = cellAt(Fl::event_x(), Fl::event_y());
+            if (cell) return route(cell, event);
+        }
+        return Group::handle(event);
+    }
+
+    // Destructor to stop the cells, deleted after the map, from updating it
+    ~HexGrid() {
+        for (std::unordered_map<uint64_t, Slot>::iterator it = cells.begin(); it != cells.end(); ++it) {
+            it->second.cell->grid = nullptr;
+        }
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -2,7 +2,14 @@
 #define BOBCAT_UI_IMAGE
 
 #include "textbox.h"
+#include "image_cache.h"
+#include "mipmap.h"
+#include "worker_pool.h"
+#include "filter.h"
+#include <FL/Fl.H>
 #include <FL/Fl_PNG_Image.H>
+#include <atomic>
+#include <memory>
 #include <string>
 #include <iostream>
 
@@ -10,28 +17,92 @@ namespace bobcat {
 
 // Image class inheriting from TextBox
 class Image : public TextBox {
-    Fl_PNG_Image *original; // Original image
-    Fl_PNG_Image *img; // Current image
+    std::shared_ptr<Fl_Image> original; // Original image, shared through ImageCache until a filter is applied
+    std::shared_ptr<MipPyramid> mips; // Downscaled levels of the original, built on first use
+    Fl_Image *img; // Current image, scaled to fit the box
     std::string fname; // Filename of the image
 
+    // State shared between the widget and a background load started by setImageAsync
+    struct AsyncLoad {
+        std::atomic<bool> cancelled; // Set when the load was superseded or the widget is gone
+        std::atomic<bool> done; // Set by the worker when the result is ready
+        std::string filename; // File being loaded
+        int boxW, boxH; // Size of the box when the load started
+        std::shared_ptr<Fl_PNG_Image> original; // Decoded image
+        std::shared_ptr<MipPyramid> mips; // Levels of the decoded image
+        Fl_Image *scaled; // Image scaled to the box, owned until taken by the widget
+
+        AsyncLoad() : cancelled(false), done(false), boxW(0), boxH(0), scaled(nullptr) {}
+
+        ~AsyncLoad() {
+            delete scaled;
+        }
+    };
+
+    std::shared_ptr<AsyncLoad> pending; // Load in progress, nullptr if none
+
+    // Scale the levels of an image to fit a box, keeping the aspect ratio of the source
+    static Fl_Image *fitted(const MipPyramid &levels, const Fl_Image *source, int boxW, int boxH) {
+        if (source->w() <= 0 || source->h() <= 0) return nullptr;
+        if (source->w() > source->h()) {
+            return levels.scaled(boxW, boxH * source->h() / source->w());
+        }
+        return levels.scaled(boxW * source->w() / source->h(), boxH);
+    }
+
+    // Replace the current image with the original scaled to fit the box, keeping its aspect ratio
+    void fit() {
+        if (!mips) mips = MipPyramid::of(original);
+
+        Fl_Image *temp = fitted(*mips, original.get(), Fl_Box::w(), Fl_Box::h());
+        delete img;
+        img = temp;
+    }
+
+    // Stop waiting for the load in progress, its result is dropped by the worker
+    void cancelLoad() {
+        if (pending) {
+            pending->cancelled = true;
+            pending = nullptr;
+        }
+        Fl::remove_timeout(pollLoad, this);
+    }
+
+    // Check on the UI thread whether the background load finished and swap its result in
+    static void pollLoad(void *data) {
+        Image *self = (Image *)data;
+        std::shared_ptr<AsyncLoad> job = self->pending;
+        if (!job) return;
+        if (!job->done) {
+            Fl::repeat_timeout(1.0 / 60, pollLoad, data);
+            return;
+        }
+        self->pending = nullptr;
+
+        self->fname = job->filename;
+        self->original = job->original;
+        self->mips = job->mips;
+        if (job->boxW == self->Fl_Box::w() && job->boxH == self->Fl_Box::h()) {
+            delete self->img;
+            self->img = job->scaled;
+            job->scaled = nullptr;
+        } else {
+            // The box was resized while loading, rescale from the levels
+            self->fit();
+        }
+        self->image(self->img);
+        self->redraw();
+    }
+
 public:
     // Constructor to initialize the image with position, size, filename, and title
     Image(int x, int y, int w, int h, std::string filename, std::string title = "" ) : TextBox(x, y, w, h, title.c_str()) {
         align(FL_ALIGN_CENTER);
         fname = filename;
-        original = new Fl_PNG_Image(filename.c_str());
-
-        img = (Fl_PNG_Image*)original->copy();
-
-        Fl_Image *temp;
-        if (img->w() > img->h()) {
-            temp = img->copy(Fl_Box::w(), Fl_Box::h() * img->h() / img->w());
-        } else {
-            temp = img->copy(Fl_Box::w() * img->w() / img->h(), Fl_Box::h());
-        }
-        delete img;
-        img = (Fl_PNG_Image *)temp;
+        original = ImageCache::shared().load(filename);
+        img = nullptr;
 
+        fit();
         image(img);
 
         Fl_Box::align(FL_ALIGN_IMAGE_MASK);
@@ -43,17 +114,7 @@ public:
         w(w() + amount);
         h(h() + amount);
 
-        delete img;
-        img = (Fl_PNG_Image*)original->copy();
-
-        Fl_Image *temp;
-        if (img->w() > img->h()) {
-            temp = img->copy(Fl_Box::w(), Fl_Box::h() * img->h() / img->w());
-        } else {
-            temp = img->copy(Fl_Box::w() * img->w() / img->h(), Fl_Box::h());
-        }
-        delete img;
-        img = (Fl_PNG_Image *)temp;
+        fit();
         image(img);
         show();
     }
@@ -64,56 +125,79 @@ public:
         w(w() - amount);
         h(h() - amount);
 
-        delete img;
-        img = new Fl_PNG_Image(fname.c_str());
-
-        Fl_Image *temp;
-        if (img->w() > img->h()) {
-            temp = img->copy(Fl_Box::w(), Fl_Box::h() * img->h() / img->w());
-        } else {
-            temp = img->copy(Fl_Box::w() * img->w() / img->h(), Fl_Box::h());
-        }
-        delete img;
-        img = (Fl_PNG_Image *)temp;
+        fit();
         image(img);
         show();
     }
 
     // Move the image to the left
+    // Only the old and new areas are redrawn, and the image itself is drawn from the already scaled copy
     void moveLeft(int amount = 10) {
-        hide();
-        x(x() - amount);
-        show();
+        moveBy(-amount, 0);
     }
 
     // Move the image to the right
     void moveRight(int amount = 10) {
-        hide();
-        x(x() + amount);
-        show();
+        moveBy(amount, 0);
     }
 
     // Set a new image
     void setImage(std::string filename) {
-        delete original;
+        cancelLoad();
         fname = filename;
-        original = new Fl_PNG_Image(filename.c_str());
-        img = (Fl_PNG_Image*)original->copy();
+        original = ImageCache::shared().load(filename);
+        mips = nullptr;
 
-        Fl_Image *temp;
-        if (img->w() > img->h()) {
-            temp = img->copy(Fl_Box::w(), Fl_Box::h() * img->h() / img->w());
-        } else {
-            temp = img->copy(Fl_Box::w() * img->w() / img->h(), Fl_Box::h());
-        }
-        delete img;
-        img = (Fl_PNG_Image *)temp;
+        fit();
         hide();
         image(img);
         redraw();
         show();
     }
 
+    // Set a new image, decoding and scaling it on a worker thread
+    // The previous image stays visible until the new one is ready, and a
+    // later call to setImage or setImageAsync cancels a load still in progress
+    void setImageAsync(std::string filename) {
+        cancelLoad();
+
+        std::shared_ptr<AsyncLoad> job = std::make_shared<AsyncLoad>();
+        job->filename = filename;
+        job->boxW = Fl_Box::w();
+        job->boxH = Fl_Box::h();
+        pending = job;
+
+        WorkerPool::shared().submit([job] {
+            if (job->cancelled) return;
+            job->original = ImageCache::shared().load(job->filename);
+            if (job->cancelled) return;
+            job->mips = MipPyramid::of(job->original);
+            if (job->cancelled) return;
+            job->scaled = fitted(*job->mips, job->original.get(), job->boxW, job->boxH);
+            job->done = true;
+        });
+        Fl::add_timeout(1.0 / 60, pollLoad, this);
+    }
+
+    // Apply a filter pipeline to the image, filters add up until a new image is set
+    // The cached original is left untouched, the widget keeps its own filtered copy
+    void applyFilter(const FilterPipeline &filters) {
+        if (!original) return;
+        Fl_RGB_Image *filtered = filters.apply(original.get());
+        if (!filtered) return;
+        original = std::shared_ptr<Fl_Image>(filtered);
+        mips = nullptr;
+
+        fit();
+        image(img);
+        redraw();
+    }
+
+    // Check if a background load is in progress
+    bool loading() const {
+        return pending != nullptr;
+    }
+
     // Set the alignment of the image
     void align(Fl_Align alignment) {
         Fl_Box::align(alignment);
@@ -153,6 +237,13 @@ public:
         parent()->redraw();
     }
     
+    // Destructor to delete the scaled image, the original stays in the cache
+    ~Image() {
+        cancelLoad();
+        image(nullptr);
+        delete img;
+    }
+
     // Friend declaration for AppTest struct
     friend struct ::AppTest;
 };
@@ -0,0 +1,191 @@
+#ifndef BOBCAT_UI_IMAGE_CACHE
+#define BOBCAT_UI_IMAGE_CACHE
+
+#include "bobcat_ui.h"
+#include "asset_bundle.h"
+#include <FL/Fl_PNG_Image.H>
+#include <sys/stat.h>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace bobcat {
+
+// Counters reported by ImageCache::stats()
+struct ImageCacheStats {
+    unsigned long hits; // Loads served from the cache
+    unsigned long misses; // Loads that had to decode the file
+    unsigned long evictions; // Entries dropped to stay within the budget
+    size_t bytes; // Decoded bytes currently held by the cache
+    size_t budget; // Byte budget of the cache
+    int entries; // Number of cached images
+};
+
+/**
+ * @class ImageCache
+ * @brief Process-wide cache of decoded PNG images.
+ *
+ * Images are keyed by file path and modification time, so an edited file is
+ * decoded again while unchanged files are shared by every widget that shows
+ * them. Callers hold std::shared_ptr references; the cache drops its own
+ * reference to the least recently used images once the decoded bytes exceed
+ * the budget, skipping images that are still in use.
+ */
+class ImageCache {
+    struct Entry {
+        std::shared_ptr<Fl_PNG_Image> image; // Decoded image
+        time_t mtime; // Modification time of the file when it was decoded, -1 for bundled assets
+        size_t bytes; // Decoded size of the image
+        std::list<std::string>::iterator use; // Position in the recency list
+    };
+
+    std::unordered_map<std::string, Entry> entries; // Cached images by path
+    std::list<std::string> recency; // Paths, most recently used first
+    std::mutex lock; // Guards every member, loads may come from worker threads
+    size_t total; // Decoded bytes held by entries
+    size_t limit; // Byte budget
+    unsigned long hits, misses, evictions; // Statistics
+
+    // Get the modification time of a file, 0 if it does not exist
+    static time_t modified(const std::string &path) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) return 0;
+        return info.st_mtime;
+    }
+
+    // Get the decoded size of an image
+    static size_t sizeOf(const Fl_Image *img) {
+        return (size_t)img->w() * img->h() * img->d();
+    }
+
+    // Remove an entry, lock must be held
+    void drop(std::unordered_map<std::string, Entry>::iterator it) {
+        total -= it->second.bytes;
+        recency.erase(it->second.use);
+        entries.erase(it);
+    }
+
+    // Drop unused images, least recently used first, until the budget is met, lock must be held
+    void trim() {
+        std::list<std::string>::iterator it = recency.end();
+        while (total > limit && it != recency.begin()) {
+            --it;
+            std::unordered_map<std::string, Entry>::iterator entry = entries.find(*it);
+            if (entry->second.image.use_count() > 1) continue;
+            // Step past the victim so the next iteration visits the one before it
+            ++it;
+            drop(entry);
+            evictions++;
+        }
+    }
+
+public:
+    // Constructor to set the byte budget
+    ImageCache(size_t budget = 256u * 1024u * 1024u) {
+        total = 0;
+        limit = budget;
+        hits = 0;
+        misses = 0;
+        evictions = 0;
+    }
+
+    // Get the cache shared by all bobcat widgets
+    static ImageCache &shared() {
+        static ImageCache cache;
+        return cache;
+    }
+
+    // Get the decoded image of a PNG file, decoding it only if it is not cached or changed on disk
+    // Files embedded in the AssetBundle are decoded from memory and never checked on disk
+    std::shared_ptr<Fl_PNG_Image> load(const std::string &path) {
+        bool bundled = AssetBundle::shared().find(path) != nullptr;
+        time_t mtime = bundled ? (time_t)-1 : modified(path);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            std::unordered_map<std::string, Entry>::iterator it = entries.find(path);
+            if (it != entries.end()) {
+                if (it->second.mtime == mtime) {
+                    hits++;
+                    recency.splice(recency.begin(), recency, it->second.use);
+                    return it->second.image;
+                }
+                drop(it);
+            }
+            misses++;
+        }
+
+        // Decode without holding the lock so other loads are not blocked
+        std::shared_ptr<Fl_PNG_Image> image(AssetBundle::loadPNG(path));
+        if (image->fail() || mtime == 0) return image;
+
+        std::lock_guard<std::mutex> guard(lock);
+        std::unordered_map<std::string, Entry>::iterator it = entries.find(path);
+        if (it != entries.end()) {
+            // Another thread decoded the same file in the meantime
+            if (it->second.mtime == mtime) return it->second.image;
+            drop(it);
+        }
+        recency.push_front(path);
+        Entry entry;
+        entry.image = image;
+        entry.mtime = mtime;
+        entry.bytes = sizeOf(image.get());
+        entry.use = recency.begin();
+        entries[path] = entry;
+        total += entry.bytes;
+        trim();
+        return image;
+    }
+
+    // Get the byte budget
+    size_t budget() {
+        std::lock_guard<std::mutex> guard(lock);
+        return limit;
+    }
+
+    // Set the byte budget, evicting unused images if needed
+    void budget(size_t bytes) {
+        std::lock_guard<std::mutex> guard(lock);
+        limit = bytes;
+        trim();
+    }
+
+    // Get the hit, miss and size statistics
+    ImageCacheStats stats() {
+        std::lock_guard<std::mutex> guard(lock);
+        ImageCacheStats s;
+        s.hits = hits;
+        s.misses = misses;
+        s.evictions = evictions;
+        s.bytes = total;
+        s.budget = limit;
+        s.entries = (int)entries.size();
+        return s;
+    }
+
+    // Reset the hit, miss and eviction counters
+    void resetStats() {
+        std::lock_guard<std::mutex> guard(lock);
+        hits = 0;
+        misses = 0;
+        evictions = 0;
+    }
+
+    // Drop every cached image, images still in use stay alive with their holders
+    void clear() {
+        std::lock_guard<std::mutex> guard(lock);
+        entries.clear();
+        recency.clear();
+        total = 0;
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
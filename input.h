@@ -2,12 +2,15 @@
 #define BOBCAT_UI_INPUT
 
 #include "bobcat_ui.h"
+#include "callbacks.h"
+#include "label_pool.h"
 
 #include <FL/Enumerations.H>
 #include <FL/Fl_Input.H>
 #include <FL/Fl_Widget.H>
 
 #include <string>
+#include <string_view>
 #include <functional>
 
 // #include <FL/names.h>
@@ -16,39 +19,23 @@ namespace bobcat {
 
 // Input class inheriting from Fl_Input
 class Input: public Fl_Input{
-    std::string caption; // Caption of the input
-
-    // Callback functions for various events
-    std::function<void(bobcat::Widget *)> onClickCb;
-    std::function<void(bobcat::Widget *)> onEnterCb;
-    std::function<void(bobcat::Widget *)> onLeaveCb;
-    std::function<void(bobcat::Widget *)> onChangeCb;
-
-    // Initialize the callback functions to nullptr
-    void init(){
-        onClickCb = nullptr;
-        onEnterCb = nullptr;
-        onLeaveCb = nullptr;
-        onChangeCb = nullptr;
-    }
-
     // Handle events for the input
     int handle(int event) {
         // if (event == 8 || event == 9)
         // printf("Event was %s (%d) - %s\n", fl_eventnames[event], event, value());
         int ret = Fl_Input::handle(event);
         if (event == FL_ENTER){
-            if (onEnterCb) onEnterCb(this);
+            CallbackTable::fire(this, EVENT_ENTER);
         }
 
         if (event == FL_LEAVE){
-            if (onLeaveCb) onLeaveCb(this);
+            CallbackTable::fire(this, EVENT_LEAVE);
         }
 
         if (event == FL_RELEASE){
             if (Fl::event_inside(this)){
                 if (Fl::focus() == this){
-                    if (onClickCb) onClickCb(this);
+                    CallbackTable::fire(this, EVENT_CLICK);
                 }
             }
         }
@@ -59,21 +46,18 @@ class Input: public Fl_Input{
 public:
     // Constructor to initialize the input with position, size, and caption
     Input(int x, int y, int w, int h, std::string caption = ""): Fl_Input(x, y, w, h, caption.c_str()) {
-        init();
         align(FL_ALIGN_TOP_LEFT);
-        this->caption = caption;
-        Fl_Input::copy_label(caption.c_str());
+        LabelPool::assign(this, caption);
     }
 
     // Get the label of the input
-    std::string label() const {
-        return caption;
+    std::string_view label() const {
+        return LabelPool::view(this);
     }
 
     // Set the label of the input
-    void label(std::string s){
-        Fl_Input::copy_label(s.c_str());
-        caption = s;
+    void label(std::string_view s) {
+        LabelPool::assign(this, s);
     }
 
     // Get the value of the input as a string
@@ -85,7 +69,7 @@ public:
     // Clear the value of the input
     void clear(){
         Fl_Input::value("");
-        if (onChangeCb) onChangeCb(this);
+        CallbackTable::fire(this, EVENT_CHANGE);
     }
 
     // Check if the input is empty
@@ -98,31 +82,31 @@ public:
     // Set the value of the input
     void value(std::string v){
         Fl_Input::value(v.c_str());
-        if (onChangeCb) onChangeCb(this);
+        CallbackTable::fire(this, EVENT_CHANGE);
     }
 
     // Set the onClick callback function
     void onClick(std::function<void(bobcat::Widget *)> cb){
-        onClickCb = cb;
+        CallbackTable::set(this, EVENT_CLICK, cb);
     }
 
     // Set the onEnter callback function
     void onEnter(std::function<void(bobcat::Widget *)> cb){
-        onEnterCb = cb;
+        CallbackTable::set(this, EVENT_ENTER, cb);
     }
 
     // Set the onLeave callback function
     void onLeave(std::function<void(bobcat::Widget *)> cb){
-        onLeaveCb = cb;
+        CallbackTable::set(this, EVENT_LEAVE, cb);
     }
 
     // Set the onChange callback function
     void onChange(std::function<void(bobcat::Widget *)> cb){
-        onChangeCb = cb;
+        CallbackTable::set(this, EVENT_CHANGE, cb);
         when(FL_WHEN_CHANGED);
         callback([](bobcat::Widget* sender, void* self){
             Input *in = (Input*) self;
-            in->onChangeCb(in);
+            CallbackTable::fire(in, EVENT_CHANGE);
         }, this);
     }
 
@@ -170,6 +154,12 @@ public:
         Fl_Input::take_focus();
     }
 
+    // Destructor to remove the callbacks and release the label of the input
+    ~Input() {
+        CallbackTable::clear(this);
+        LabelPool::release(this);
+    }
+
     // Friend declaration for AppTest struct
     friend struct ::AppTest;
 };
@@ -0,0 +1,121 @@
+#ifndef BOBCAT_UI_LABEL_POOL
+#define BOBCAT_UI_LABEL_POOL
+
+#include "bobcat_ui.h"
+#include <FL/Fl_Widget.H>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
+namespace bobcat {
+
+/**
+ * @class LabelPool
+ * @brief Interned, reference counted storage for widget labels.
+ *
+ * Each distinct label text is stored once and handed to FLTK without being
+ * copied; widgets showing the same text share it, and the text is freed when
+ * the last widget using it changes its label or is destroyed. Reading a label
+ * returns a std::string_view into the pool, so it never allocates. The view
+ * is only valid until the widget is relabeled or destroyed; copy it into a
+ * std::string to keep the text longer. Only used from the UI thread.
+ */
+class LabelPool {
+    // One interned text
+    struct Entry {
+        std::unique_ptr<char[]> text; // Null terminated copy, the map key views it
+        size_t refs; // Number of widgets using the text
+    };
+
+    std::unordered_map<std::string_view, Entry> entries; // Interned texts
+    size_t total; // Bytes held by the texts
+
+    LabelPool() {
+        total = 0;
+    }
+
+public:
+    // Get the pool shared by all bobcat widgets
+    static LabelPool &shared() {
+        static LabelPool pool;
+        return pool;
+    }
+
+    // Get a pooled copy of a text and add a reference to it
+    const char *intern(std::string_view s) {
+        std::unordered_map<std::string_view, Entry>::iterator it = entries.find(s);
+        if (it == entries.end()) {
+            Entry e;
+            e.text.reset(new char[s.size() + 1]);
+            memcpy(e.text.get(), s.data(), s.size());
+            e.text[s.size()] = 0;
+            e.refs = 0;
+            std::string_view key(e.text.get(), s.size());
+            it = entries.emplace(key, std::move(e)).first;
+            total += s.size() + 1;
+        }
+        it->second.refs++;
+        return it->second.text.get();
+    }
+
+    // Drop a reference to a pooled text, texts that are not from the pool are ignored
+    void release(const char *text) {
+        if (!text) return;
+        std::unordered_map<std::string_view, Entry>::iterator it = entries.find(std::string_view(text));
+        if (it == entries.end() || it->second.text.get() != text) return;
+        if (--it->second.refs == 0) {
+            total -= it->first.size() + 1;
+            entries.erase(it);
+        }
+    }
+
+    // Get the number of widgets sharing a pooled text, 0 if the text is not from the pool
+    size_t refs(const char *text) const {
+        if (!text) return 0;
+        std::unordered_map<std::string_view, Entry>::const_iterator it = entries.find(std::string_view(text));
+        if (it == entries.end() || it->second.text.get() != text) return 0;
+        return it->second.refs;
+    }
+
+    // Get the number of distinct texts
+    size_t count() const {
+        return entries.size();
+    }
+
+    // Get the bytes held by the texts
+    size_t bytes() const {
+        return total;
+    }
+
+    // Get the label of a widget without copying it
+    static std::string_view view(const Fl_Widget *widget) {
+        const char *l = widget->label();
+        return l ? std::string_view(l) : std::string_view();
+    }
+
+    // Set the label of a widget to a pooled text, returns false if the label already had that text
+    static bool assign(Fl_Widget *widget, std::string_view s) {
+        const char *old = widget->label();
+        // Only a pooled label is kept, anything else may point to a temporary
+        if (shared().refs(old) > 0 && view(widget) == s) return false;
+        // Intern before releasing the old label: s may view it, and release() can free it
+        const char *text = shared().intern(s);
+        shared().release(old);
+        widget->label(text);
+        return true;
+    }
+
+    // Give up the pooled label of a widget, called by widget destructors
+    static void release(Fl_Widget *widget) {
+        shared().release(widget->label());
+        widget->label(nullptr);
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -0,0 +1,306 @@
+#ifndef BOBCAT_UI_LAYERED_CANVAS
+#define BOBCAT_UI_LAYERED_CANVAS
+
+#include "bobcat_ui.h"
+#include "canvas.h"
+#include <FL/Enumerations.H>
+#include <FL/Fl_Gl_Window.H>
+#include <GL/gl.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <functional>
+
+namespace bobcat {
+
+/**
+ * @class CanvasLayer
+ * @brief A single drawing layer of a LayeredCanvas_.
+ *
+ * A layer wraps a render function. Static layers are rendered once into an
+ * offscreen texture and composited on every frame until they are invalidated,
+ * dynamic layers are rendered on every frame.
+ */
+class CanvasLayer {
+    std::function<void()> renderCb; // Draws the content of the layer
+    bool staticContent; // Whether the layer may be served from the cache
+    bool shown; // Whether the layer is drawn at all
+    bool dirty; // Whether the cached content is out of date
+
+    // Constructor to initialize the layer with its render function
+    CanvasLayer(std::function<void()> cb, bool isStatic) {
+        renderCb = cb;
+        staticContent = isStatic;
+        shown = true;
+        dirty = true;
+    }
+
+public:
+    // Mark the content of the layer as changed
+    void invalidate() {
+        dirty = true;
+    }
+
+    // Check if the layer is static
+    bool isStatic() const {
+        return staticContent;
+    }
+
+    // Mark the layer as static or dynamic
+    void isStatic(bool value) {
+        if (staticContent != value) {
+            staticContent = value;
+            dirty = true;
+        }
+    }
+
+    // Check if the layer is visible
+    bool visible() const {
+        return shown;
+    }
+
+    // Show or hide the layer
+    void visible(bool value) {
+        if (shown != value) {
+            shown = value;
+            dirty = true;
+        }
+    }
+
+    // Replace the render function of the layer
+    void onRender(std::function<void()> cb) {
+        renderCb = cb;
+        dirty = true;
+    }
+
+    // Friend declarations
+    friend class LayeredCanvas_;
+    friend struct ::AppTest;
+};
+
+/**
+ * @class LayeredCanvas_
+ * @brief A canvas that composes its frame from an ordered list of layers.
+ *
+ * The bottom run of consecutive static layers is rendered once and copied into
+ * a texture. Later frames draw that texture as a single quad and then render the
+ * remaining layers on top. The cache is rebuilt when one of the static layers is
+ * invalidated, shown, hidden or changed to dynamic, when the canvas size changes,
+ * or when the GL context is recreated. Static layers that sit above a dynamic
+ * layer are rendered on every frame, since they cannot be composited below it.
+ */
+class LayeredCanvas_ : public Canvas_ {
+    std::vector<CanvasLayer *> layers; // Layers in drawing order, bottom first
+
+    GLuint cacheTexture; // Texture holding the composited static layers
+    int cacheW; // Width in pixels of the cached frame
+    int cacheH; // Height in pixels of the cached frame
+    int textureW; // Allocated width of the cache texture (power of two)
+    int textureH; // Allocated height of the cache texture (power of two)
+    bool cacheValid; // Whether the texture matches the static layers
+    size_t cachedRun; // Number of bottom layers the texture was rendered from
+
+    // Initialize the cache state
+    void initCache() {
+        cacheTexture = 0;
+        cacheW = 0;
+        cacheH = 0;
+        textureW = 0;
+        textureH = 0;
+        cacheValid = false;
+        cachedRun = 0;
+    }
+
+    // Round up to the next power of two, which every GL version accepts as a texture size
+    static int nextPowerOfTwo(int n) {
+        int p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    // Number of layers at the bottom that can be served from the cache
+    size_t staticRun() const {
+        size_t i = 0;
+        while (i < layers.size() && (layers[i]->staticContent || !layers[i]->shown)) {
+            i++;
+        }
+        // Hidden dynamic layers on top of the run are not part of it
+        while (i > 0 && !layers[i - 1]->staticContent) {
+            i--;
+        }
+        return i;
+    }
+
+    // Render the static run and copy the result into the cache texture
+    void rebuildCache(size_t run, int pw, int ph) {
+        for (size_t i = 0; i < run; i++) {
+            CanvasLayer *layer = layers[i];
+            if (layer->shown && layer->renderCb) layer->renderCb();
+            layer->dirty = false;
+        }
+
+        if (cacheTexture == 0) {
+            glGenTextures(1, &cacheTexture);
+            textureW = 0;
+            textureH = 0;
+        }
+        glBindTexture(GL_TEXTURE_2D, cacheTexture);
+
+        if (textureW < pw || textureH < ph) {
+            textureW = nextPowerOfTwo(pw);
+            textureH = nextPowerOfTwo(ph);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, textureW, textureH, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        }
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, pw, ph);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        cacheW = pw;
+        cacheH = ph;
+        cachedRun = run;
+        cacheValid = true;
+    }
+
+    // Draw the cache texture over the whole canvas
+    void drawCache() {
+        glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_CURRENT_BIT | GL_VIEWPORT_BIT);
+        glMatrixMode(GL_PROJECTION);
+        glPushMatrix();
+        glLoadIdentity();
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glLoadIdentity();
+
+        glViewport(0, 0, cacheW, cacheH);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
+        glDisable(GL_LIGHTING);
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, cacheTexture);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+        glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+        float u = (float)cacheW / textureW;
+        float v = (float)cacheH / textureH;
+        glBegin(GL_QUADS);
+        glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, -1.0f);
+        glTexCoord2f(u, 0.0f);    glVertex2f(1.0f, -1.0f);
+        glTexCoord2f(u, v);       glVertex2f(1.0f, 1.0f);
+        glTexCoord2f(0.0f, v);    glVertex2f(-1.0f, 1.0f);
+        glEnd();
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glPopMatrix();
+        glMatrixMode(GL_PROJECTION);
+        glPopMatrix();
+        glMatrixMode(GL_MODELVIEW);
+        glPopAttrib();
+    }
+
+public:
+    // Constructor to initialize the canvas with width, height, and title
+    LayeredCanvas_(int w, int h, std::string title = "") : Canvas_(w, h, title) {
+        initCache();
+    }
+
+    // Constructor to initialize the canvas with position, width, height, and title
+    LayeredCanvas_(int x, int y, int w, int h, std::string title = "") : Canvas_(x, y, w, h, title) {
+        initCache();
+    }
+
+    // Add a layer on top of the existing ones
+    CanvasLayer *addLayer(std::function<void()> cb, bool isStatic = false) {
+        CanvasLayer *layer = new CanvasLayer(cb, isStatic);
+        layers.push_back(layer);
+        cacheValid = false;
+        return layer;
+    }
+
+    // Remove and delete a layer
+    void removeLayer(CanvasLayer *layer) {
+        for (size_t i = 0; i < layers.size(); i++) {
+            if (layers[i] == layer) {
+                layers.erase(layers.begin() + i);
+                delete layer;
+                cacheValid = false;
+                return;
+            }
+        }
+    }
+
+    // Get the number of layers
+    int layerCount() const {
+        return (int)layers.size();
+    }
+
+    // Get the layer at a specific index, counted from the bottom
+    CanvasLayer *layer(int index) const {
+        return layers[index];
+    }
+
+    // Force every static layer to be rendered again on the next frame
+    void invalidateLayers() {
+        cacheValid = false;
+    }
+
+    // Composite the cached static layers and render the rest
+    void render() override {
+        int pw = pixel_w();
+        int ph = pixel_h();
+
+        if (!context_valid()) {
+            // A new context does not share the texture of the old one
+            cacheTexture = 0;
+            cacheValid = false;
+        }
+        if (pw != cacheW || ph != cacheH) {
+            cacheValid = false;
+        }
+
+        // A layer that joined or left the run changes what the texture must hold
+        size_t run = staticRun();
+        if (run != cachedRun) {
+            cacheValid = false;
+        }
+        size_t covered = std::max(run, cachedRun);
+        for (size_t i = 0; i < covered && i < layers.size() && cacheValid; i++) {
+            if (layers[i]->dirty) cacheValid = false;
+        }
+
+        if (run > 0) {
+            if (cacheValid) {
+                drawCache();
+            } else {
+                // The back buffer holds the static layers afterwards, so nothing to composite
+                rebuildCache(run, pw, ph);
+            }
+        }
+
+        for (size_t i = run; i < layers.size(); i++) {
+            CanvasLayer *layer = layers[i];
+            if (layer->shown && layer->renderCb) layer->renderCb();
+            layer->dirty = false;
+        }
+    }
+
+    // Destructor to delete the layers and release the cache texture
+    ~LayeredCanvas_() {
+        if (cacheTexture != 0 && shown()) {
+            make_current();
+            glDeleteTextures(1, &cacheTexture);
+        }
+        for (size_t i = 0; i < layers.size(); i++) {
+            delete layers[i];
+        }
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -0,0 +1,471 @@
+#ifndef BOBCAT_UI_LAYOUT
+#define BOBCAT_UI_LAYOUT
+
+#include "bobcat_ui.h"
+#include "spatial_index.h"
+#include <FL/Fl_Group.H>
+#include <FL/Fl_Widget.H>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace bobcat {
+
+// Kind of a Layout
+enum LAYOUT_KIND {LAYOUT_ROW, LAYOUT_COLUMN, LAYOUT_GRID};
+
+// Size constraints of one widget in a Layout
+struct Constraint {
+    double weight; // Share of the extra space in a row or column, 0 keeps the minimum size
+    int minW; // Minimum width
+    int minH; // Minimum height
+    int maxW; // Maximum width
+    int maxH; // Maximum height
+    int row; // Grid row
+    int col; // Grid column
+    int rowSpan; // Grid rows covered
+    int colSpan; // Grid columns covered
+
+    Constraint(double weight = 1, int minW = 0, int minH = 0, int maxW = INT_MAX, int maxH = INT_MAX) {
+        this->weight = weight;
+        this->minW = minW;
+        this->minH = minH;
+        this->maxW = maxW;
+        this->maxH = maxH;
+        row = 0;
+        col = 0;
+        rowSpan = 1;
+        colSpan = 1;
+    }
+};
+
+/**
+ * @class Layout
+ * @brief Places the children of a group in a row, a column or a grid.
+ *
+ * Each widget gets a minimum size, a maximum size and a weight; the space
+ * left over after the minimums is shared out by weight. A group with its own
+ * layout counts as a widget whose minimum is that of its contents, so layouts
+ * nest. Minimum sizes are cached, and a layout only runs again when its rect
+ * or one of its constraints changed: children whose rect comes out the same
+ * are not resized, so their subtrees are not laid out again. Call invalidate()
+ * after showing or hiding a child, hidden children take no space. Widgets must
+ * be children of the owner by the time the layout runs; items whose widget
+ * was removed from the owner or deleted are dropped, like remove() would.
+ *
+ * bobcat::Group runs its layout from resize() and draw(). Other groups can
+ * own a layout too and call apply() themselves.
+ */
+class Layout {
+    // A widget with its constraints
+    struct Item {
+        Fl_Widget *widget;
+        Constraint c;
+        int z; // Index of the widget in the owner's children when last checked
+    };
+
+    // A row, column or grid track being sized
+    struct Track {
+        double weight;
+        int min;
+        int max;
+    };
+
+    Fl_Group *owner; // Group whose children are placed
+    LAYOUT_KIND kind; // Row, column or grid
+    int gap; // Space between children
+    int margin; // Space around the children
+    std::vector<Item> items; // Placed children in order
+    std::vector<double> colWeights; // Grid column weights, 1 if not set
+    std::vector<double> rowWeights; // Grid row weights, 1 if not set
+    bool dirty; // Constraints changed since the last run
+    bool measured; // minW and minH are up to date
+    int minW; // Cached minimum width
+    int minH; // Cached minimum height
+    int lastX, lastY, lastW, lastH; // Rect of the last run
+    size_t runs; // Number of times the layout ran
+
+    // Get the table of layouts by owner
+    static std::unordered_map<const Fl_Widget *, Layout *> &registry() {
+        static std::unordered_map<const Fl_Widget *, Layout *> table;
+        return table;
+    }
+
+    // Find an item by widget
+    Item *find(const Fl_Widget *widget) {
+        for (size_t i = 0; i < items.size(); i++) {
+            if (items[i].widget == widget) return &items[i];
+        }
+        return nullptr;
+    }
+
+    // Drop the items whose widget is no longer a child of the owner
+    // Items are checked against the owner's child array without touching the
+    // widgets, so a child that was removed or deleted is never read
+    void validate() {
+        int n = owner->children();
+        size_t kept = 0;
+        for (size_t i = 0; i < items.size(); i++) {
+            Item &item = items[i];
+            if (item.z >= n || owner->child(item.z) != item.widget) item.z = owner->find(item.widget);
+            if (item.z < n) items[kept++] = item;
+        }
+        if (kept == items.size()) return;
+        items.resize(kept);
+        invalidate();
+    }
+
+    // Get the minimum width of an item, including the contents of a nested layout
+    static int itemMinW(const Item &item) {
+        Layout *nested = of(item.widget);
+        return std::max(item.c.minW, nested ? nested->minWidth() : 0);
+    }
+
+    // Get the minimum height of an item, including the contents of a nested layout
+    static int itemMinH(const Item &item) {
+        Layout *nested = of(item.widget);
+        return std::max(item.c.minH, nested ? nested->minHeight() : 0);
+    }
+
+    // Get the number of grid columns and rows
+    void gridSize(int &cols, int &rows) const {
+        cols = 0;
+        rows = 0;
+        for (size_t i = 0; i < items.size(); i++) {
+            if (!items[i].widget->visible()) continue;
+            cols = std::max(cols, items[i].c.col + items[i].c.colSpan);
+            rows = std::max(rows, items[i].c.row + items[i].c.rowSpan);
+        }
+    }
+
+    // Get the minimum of every grid column and row, from the widgets that cover one cell
+    void gridMins(std::vector<int> &colMin, std::vector<int> &rowMin) const {
+        int cols, rows;
+        gridSize(cols, rows);
+        colMin.assign(cols, 0);
+        rowMin.assign(rows, 0);
+        for (size_t i = 0; i < items.size(); i++) {
+            const Item &item = items[i];
+            if (!item.widget->visible()) continue;
+            if (item.c.colSpan == 1) colMin[item.c.col] = std::max(colMin[item.c.col], itemMinW(item));
+            if (item.c.rowSpan == 1) rowMin[item.c.row] = std::max(rowMin[item.c.row], itemMinH(item));
+        }
+    }
+
+    // Compute the cached minimum size
+    void measure() {
+        validate();
+        if (measured) return;
+        int sumW = 0, sumH = 0, maxW = 0, maxH = 0, n = 0;
+        if (kind == LAYOUT_GRID) {
+            std::vector<int> colMin, rowMin;
+            gridMins(colMin, rowMin);
+            for (size_t i = 0; i < colMin.size(); i++) sumW += colMin[i];
+            for (size_t i = 0; i < rowMin.size(); i++) sumH += rowMin[i];
+            minW = sumW + gap * std::max(0, (int)colMin.size() - 1) + 2 * margin;
+            minH = sumH + gap * std::max(0, (int)rowMin.size() - 1) + 2 * margin;
+        } else {
+            for (size_t i = 0; i < items.size(); i++) {
+                if (!items[i].widget->visible()) continue;
+                int w = itemMinW(items[i]), h = itemMinH(items[i]);
+                sumW += w;
+                sumH += h;
+                maxW = std::max(maxW, w);
+                maxH = std::max(maxH, h);
+                n++;
+            }
+            int gaps = gap * std::max(0, n - 1);
+            minW = (kind == LAYOUT_ROW ? sumW + gaps : maxW) + 2 * margin;
+            minH = (kind == LAYOUT_COLUMN ? sumH + gaps : maxH) + 2 * margin;
+        }
+        measured = true;
+    }
+
+    // Size tracks to fill space: every track gets its minimum, the rest is shared
+    // by weight, and a track that reaches its maximum gives its share back
+    static void distribute(const std::vector<Track> &tracks, int space, int start, int gap, std::vector<int> &pos, std::vector<int> &size) {
+        size_t n = tracks.size();
+        std::vector<double> s(n);
+        std::vector<char> frozen(n);
+        double left = space - gap * std::max(0, (int)n - 1);
+        for (size_t i = 0; i < n; i++) {
+            s[i] = tracks[i].min;
+            left -= tracks[i].min;
+            frozen[i] = tracks[i].weight <= 0 || tracks[i].min >= tracks[i].max;
+        }
+
+        while (left > 0) {
+            double total = 0;
+            for (size_t i = 0; i < n; i++) {
+                if (!frozen[i]) total += tracks[i].weight;
+            }
+            if (total <= 0) break;
+
+            double used = 0;
+            bool clamped = false;
+            for (size_t i = 0; i < n; i++) {
+                if (frozen[i] || s[i] + left * tracks[i].weight / total <= tracks[i].max) continue;
+                used += tracks[i].max - s[i];
+                s[i] = tracks[i].max;
+                frozen[i] = 1;
+                clamped = true;
+            }
+            if (clamped) {
+                left -= used;
+                continue;
+            }
+            for (size_t i = 0; i < n; i++) {
+                if (!frozen[i]) s[i] += left * tracks[i].weight / total;
+            }
+            break;
+        }
+
+        // Round the edges rather than the sizes so the tracks never drift apart
+        pos.resize(n);
+        size.resize(n);
+        double at = start;
+        for (size_t i = 0; i < n; i++) {
+            pos[i] = (int)std::lround(at);
+            size[i] = (int)std::lround(at + s[i]) - pos[i];
+            at += s[i] + gap;
+        }
+    }
+
+    // Move a widget, or bring its own layout up to date if it stays put
+    static void place(Fl_Widget *widget, int x, int y, int w, int h) {
+        if (widget->x() != x || widget->y() != y || widget->w() != w || widget->h() != h) {
+            widget->resize(x, y, w, h);
+            SpatialIndex::moved(widget);
+            return;
+        }
+        Layout *nested = of(widget);
+        if (nested) nested->apply();
+    }
+
+    // Place the children of a row or column
+    void runLine(int x, int y, int w, int h) {
+        bool row = kind == LAYOUT_ROW;
+        std::vector<Item *> shown;
+        std::vector<Track> tracks;
+        for (size_t i = 0; i < items.size(); i++) {
+            Item &item = items[i];
+            if (!item.widget->visible()) continue;
+            Track t;
+            t.weight = item.c.weight;
+            t.min = row ? itemMinW(item) : itemMinH(item);
+            t.max = std::max(t.min, row ? item.c.maxW : item.c.maxH);
+            shown.push_back(&item);
+            tracks.push_back(t);
+        }
+
+        std::vector<int> pos, size;
+        distribute(tracks, (row ? w : h) - 2 * margin, (row ? x : y) + margin, gap, pos, size);
+        int cross = (row ? h : w) - 2 * margin;
+        for (size_t i = 0; i < shown.size(); i++) {
+            Item &item = *shown[i];
+            int lo = row ? itemMinH(item) : itemMinW(item);
+            int hi = std::max(lo, row ? item.c.maxH : item.c.maxW);
+            int c = std::max(lo, std::min(cross, hi));
+            if (row) {
+                place(item.widget, pos[i], y + margin, size[i], c);
+            } else {
+                place(item.widget, x + margin, pos[i], c, size[i]);
+            }
+        }
+    }
+
+    // Place the children of a grid
+    void runGrid(int x, int y, int w, int h) {
+        std::vector<int> colMin, rowMin;
+        gridMins(colMin, rowMin);
+        std::vector<Track> cols(colMin.size()), rows(rowMin.size());
+        for (size_t i = 0; i < cols.size(); i++) {
+            cols[i].weight = i < colWeights.size() ? colWeights[i] : 1;
+            cols[i].min = colMin[i];
+            cols[i].max = INT_MAX;
+        }
+        for (size_t i = 0; i < rows.size(); i++) {
+            rows[i].weight = i < rowWeights.size() ? rowWeights[i] : 1;
+            rows[i].min = rowMin[i];
+            rows[i].max = INT_MAX;
+        }
+
+        std::vector<int> colPos, colSize, rowPos, rowSize;
+        distribute(cols, w - 2 * margin, x + margin, gap, colPos, colSize);
+        distribute(rows, h - 2 * margin, y + margin, gap, rowPos, rowSize);
+        for (size_t i = 0; i < items.size(); i++) {
+            Item &item = items[i];
+            if (!item.widget->visible()) continue;
+            int c0 = item.c.col, c1 = item.c.col + item.c.colSpan - 1;
+            int r0 = item.c.row, r1 = item.c.row + item.c.rowSpan - 1;
+            int cw = colPos[c1] + colSize[c1] - colPos[c0];
+            int ch = rowPos[r1] + rowSize[r1] - rowPos[r0];
+            int iw = std::max(itemMinW(item), std::min(cw, item.c.maxW));
+            int ih = std::max(itemMinH(item), std::min(ch, item.c.maxH));
+            place(item.widget, colPos[c0], rowPos[r0], iw, ih);
+        }
+    }
+
+public:
+    // Constructor to lay out the children of owner
+    Layout(Fl_Group *owner, LAYOUT_KIND kind, int gap = 0, int margin = 0) {
+        this->owner = owner;
+        this->kind = kind;
+        this->gap = gap;
+        this->margin = margin;
+        dirty = true;
+        measured = false;
+        minW = 0;
+        minH = 0;
+        lastX = lastY = lastW = lastH = -1;
+        runs = 0;
+        registry()[owner] = this;
+    }
+
+    // Get the layout owned by a group, or null
+    static Layout *of(const Fl_Widget *widget) {
+        std::unordered_map<const Fl_Widget *, Layout *>::iterator it = registry().find(widget);
+        return it == registry().end() ? nullptr : it->second;
+    }
+
+    // Add a widget, min and max are its width in a row and its height in a column
+    Layout &add(Fl_Widget *widget, double weight = 1, int min = 0, int max = INT_MAX) {
+        Constraint c(weight);
+        if (kind == LAYOUT_COLUMN) {
+            c.minH = min;
+            c.maxH = max;
+        } else {
+            c.minW = min;
+            c.maxW = max;
+        }
+        return add(widget, c);
+    }
+
+    // Add a widget with full constraints, or change the constraints of one already added
+    Layout &add(Fl_Widget *widget, const Constraint &c) {
+        Item *item = find(widget);
+        if (item) {
+            item->c = c;
+        } else {
+            Item added;
+            added.widget = widget;
+            added.c = c;
+            added.z = owner->find(widget);
+            items.push_back(added);
+        }
+        invalidate();
+        return *this;
+    }
+
+    // Add a widget to a grid cell
+    Layout &cell(Fl_Widget *widget, int row, int col, int rowSpan = 1, int colSpan = 1, const Constraint &c = Constraint()) {
+        Constraint placed = c;
+        placed.row = std::max(0, row);
+        placed.col = std::max(0, col);
+        placed.rowSpan = std::max(1, rowSpan);
+        placed.colSpan = std::max(1, colSpan);
+        return add(widget, placed);
+    }
+
+    // Stop placing a widget
+    void remove(Fl_Widget *widget) {
+        for (size_t i = 0; i < items.size(); i++) {
+            if (items[i].widget == widget) {
+                items.erase(items.begin() + i);
+                invalidate();
+                return;
+            }
+        }
+    }
+
+    // Stop placing every widget
+    void clear() {
+        items.clear();
+        invalidate();
+    }
+
+    // Set the weight of a grid column
+    void columnWeight(int col, double weight) {
+        if (col < 0) return;
+        if ((size_t)col >= colWeights.size()) colWeights.resize(col + 1, 1);
+        colWeights[col] = weight;
+        invalidate();
+    }
+
+    // Set the weight of a grid row
+    void rowWeight(int row, double weight) {
+        if (row < 0) return;
+        if ((size_t)row >= rowWeights.size()) rowWeights.resize(row + 1, 1);
+        rowWeights[row] = weight;
+        invalidate();
+    }
+
+    // Set the space between children and around them
+    void spacing(int gap, int margin) {
+        this->gap = gap;
+        this->margin = margin;
+        invalidate();
+    }
+
+    // Mark the layout, and the layouts it is nested in, to run again
+    void invalidate() {
+        dirty = true;
+        measured = false;
+        owner->redraw();
+        Layout *outer = owner->parent() ? of(owner->parent()) : nullptr;
+        if (outer && outer->find(owner)) outer->invalidate();
+    }
+
+    // Get the smallest width that fits the children
+    int minWidth() {
+        measure();
+        return minW;
+    }
+
+    // Get the smallest height that fits the children
+    int minHeight() {
+        measure();
+        return minH;
+    }
+
+    // Place the children in the owner's rect if it or a constraint changed
+    void apply() {
+        apply(owner->x(), owner->y(), owner->w(), owner->h());
+    }
+
+    // Place the children in a rect if it or a constraint changed
+    void apply(int x, int y, int w, int h) {
+        validate();
+        if (!dirty && x == lastX && y == lastY && w == lastW && h == lastH) return;
+        dirty = false;
+        lastX = x;
+        lastY = y;
+        lastW = w;
+        lastH = h;
+        runs++;
+        if (kind == LAYOUT_GRID) {
+            runGrid(x, y, w, h);
+        } else {
+            runLine(x, y, w, h);
+        }
+    }
+
+    // Get the number of times the layout ran
+    size_t runCount() const {
+        return runs;
+    }
+
+    // Destructor to unregister the layout
+    ~Layout() {
+        registry().erase(owner);
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -2,42 +2,29 @@
 #define BOBCAT_UI_LIST_BOX
 
 #include "bobcat_ui.h"
+#include "callbacks.h"
+#include "label_pool.h"
 #include <FL/Enumerations.H>
 #include <FL/Fl_Hold_Browser.H>
 #include <FL/Fl_Widget.H>
 #include <functional>
 #include <string>
+#include <string_view>
 #include <iostream>
 
 namespace bobcat {
 
 // ListBox class inheriting from Fl_Hold_Browser
 class ListBox : public Fl_Hold_Browser {
-    std::string caption; // Caption of the list box
-
-    // Callback functions for various events
-    std::function<void(bobcat::Widget *)> onChangeCb;
-    std::function<void(bobcat::Widget *)> onClickCb;
-    std::function<void(bobcat::Widget *)> onEnterCb;
-    std::function<void(bobcat::Widget *)> onLeaveCb;
-
-    // Initialize the callback functions to nullptr
-    void init() {
-        onClickCb = nullptr;
-        onEnterCb = nullptr;
-        onLeaveCb = nullptr;
-        onChangeCb = nullptr;
-    }
-
     // Handle events for the list box
     int handle(int event) {
         int ret = Fl_Hold_Browser::handle(event);
         if (event == FL_ENTER) {
-            if (onEnterCb) onEnterCb(this);
+            CallbackTable::fire(this, EVENT_ENTER);
         }
 
         if (event == FL_LEAVE) {
-            if (onLeaveCb) onLeaveCb(this);
+            CallbackTable::fire(this, EVENT_LEAVE);
         }
 
         return ret;
@@ -46,20 +33,18 @@ class ListBox : public Fl_Hold_Browser {
 public:
     // Constructor to initialize the list box with position, size, and title
     ListBox(int x, int y, int w, int h, std::string title = "") : Fl_Hold_Browser(x, y, w, h, title.c_str()) {
-        init();
         align(FL_ALIGN_TOP_LEFT);
-        Fl_Hold_Browser::copy_label(title.c_str());
+        LabelPool::assign(this, title);
     }
 
     // Get the label of the list box
-    std::string label() const {
-        return caption;
+    std::string_view label() const {
+        return LabelPool::view(this);
     }
 
     // Set the label of the list box
-    void label(std::string s) {
-        Fl_Hold_Browser::copy_label(s.c_str());
-        caption = s;
+    void label(std::string_view s) {
+        LabelPool::assign(this, s);
     }
 
     // Get the selected item text
@@ -87,37 +72,37 @@ public:
                     break;
                 }
             }
-            if (onChangeCb) onChangeCb(this);
+            CallbackTable::fire(this, EVENT_CHANGE);
         }
     }
 
     // Add an item to the list box
     void add(std::string text) {
         Fl_Hold_Browser::add(text.c_str());
-        if (onChangeCb) onChangeCb(this);
+        CallbackTable::fire(this, EVENT_CHANGE);
     }
 
     // Set the onChange callback function
     void onChange(std::function<void(bobcat::Widget *)> cb) {
-        onChangeCb = cb;
+        CallbackTable::set(this, EVENT_CHANGE, cb);
     }
 
     // Set the onEnter callback function
     void onEnter(std::function<void(bobcat::Widget *)> cb) {
-        onEnterCb = cb;
+        CallbackTable::set(this, EVENT_ENTER, cb);
     }
 
     // Set the onLeave callback function
     void onLeave(std::function<void(bobcat::Widget *)> cb) {
-        onLeaveCb = cb;
+        CallbackTable::set(this, EVENT_LEAVE, cb);
     }
 
     // Set the onClick callback function
     void onClick(std::function<void(bobcat::Widget *)> cb) {
-        onClickCb = cb;
+        CallbackTable::set(this, EVENT_CLICK, cb);
         callback([](bobcat::Widget* sender, void* self) {
             ListBox* butt = (ListBox*) self;
-            butt->onClickCb(butt);
+            CallbackTable::fire(butt, EVENT_CLICK);
         }, this);
     }
 
@@ -165,6 +150,12 @@ public:
         Fl_Hold_Browser::take_focus();
     }
 
+    // Destructor to remove the callbacks and release the label of the list box
+    ~ListBox() {
+        CallbackTable::clear(this);
+        LabelPool::release(this);
+    }
+
     // Friend declaration for AppTest struct
     friend struct ::AppTest;
 };
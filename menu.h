@@ -2,10 +2,14 @@
 #define BOBCAT_UI_MENU
 
 #include "bobcat_ui.h"
+#include "callbacks.h"
+#include "label_pool.h"
 #include <FL/Enumerations.H>
 #include <FL/Fl_Menu_Bar.H>
 #include <FL/Fl_Widget.H>
 #include <map>
+#include <string>
+#include <string_view>
 #include <vector>
 #include <functional>
 #include <iostream>
@@ -14,36 +18,36 @@ namespace bobcat {
 
 // MenuItem class inheriting from Fl_Widget
 class MenuItem : public Fl_Widget {
-    std::string caption; // Caption of the menu item
-    std::function<void(bobcat::Widget *)> onClickCb; // Callback function for click event
-
 public:
     // Constructor to initialize the menu item with a caption
     MenuItem(std::string caption) : Fl_Widget(0, 0, 0, 0, caption.c_str()) {
-        onClickCb = nullptr;
-        Fl_Widget::copy_label(caption.c_str());
-        this->caption = caption;
+        LabelPool::assign(this, caption);
     }
 
     // Set the onClick callback function
     void onClick(std::function<void(bobcat::Widget *)> cb) {
-        onClickCb = cb;
+        CallbackTable::set(this, EVENT_CLICK, cb);
     }
 
     // Get the label of the menu item
-    std::string label() const {
-        return caption;
+    std::string_view label() const {
+        return LabelPool::view(this);
     }
 
     // Set the label of the menu item
-    void label(std::string s) {
-        Fl_Widget::copy_label(s.c_str());
-        caption = s;
+    void label(std::string_view s) {
+        LabelPool::assign(this, s);
     }
 
     // Override the draw method (empty implementation)
     void draw() {}
 
+    // Destructor to remove the callbacks and release the label of the menu item
+    ~MenuItem() {
+        CallbackTable::clear(this);
+        LabelPool::release(this);
+    }
+
     // Friend declarations
     friend class Menu;
     friend struct ::AppTest;
@@ -60,7 +64,7 @@ class Menu : public Fl_Menu_Bar {
 
         Menu *self = (Menu *)data;
         MenuItem *curr = self->items[index];
-        if (curr->onClickCb) curr->onClickCb(curr);
+        CallbackTable::fire(curr, EVENT_CLICK);
     }
 
     // Helper function to split a string by a delimiter
@@ -105,13 +109,13 @@ public:
 
     // Add a menu item to the menu
     void addItem(MenuItem *item) {
-        int pos = add(addPadding(item->label()).c_str(), 0, handler, this);
+        int pos = add(addPadding(std::string(item->label())).c_str(), 0, handler, this);
         items.insert(std::pair<int, MenuItem*>(pos, item));
     }
 
     // Add a menu item with a separator to the menu
     void addItemSep(MenuItem *item) {
-        int pos = add(addPadding(item->label()).c_str(), 0, handler, this, FL_MENU_DIVIDER);
+        int pos = add(addPadding(std::string(item->label())).c_str(), 0, handler, this, FL_MENU_DIVIDER);
         items.insert(std::pair<int, MenuItem*>(pos, item));
     }
 
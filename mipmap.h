@@ -0,0 +1,132 @@
+#ifndef BOBCAT_UI_MIPMAP
+#define BOBCAT_UI_MIPMAP
+
+#include "bobcat_ui.h"
+#include "pixel_buffer.h"
+#include "resample.h"
+#include <FL/Fl_Image.H>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace bobcat {
+
+/**
+ * @class MipPyramid
+ * @brief Successively halved copies of an image, built once per source.
+ *
+ * Scaling picks the smallest level that is still at least as large as the
+ * requested size and resamples from it, so zooming never goes back to disk
+ * and never resamples more than twice the pixels it produces. Pyramids are
+ * shared by every widget showing the same source image through of().
+ */
+class MipPyramid {
+    std::shared_ptr<Fl_Image> source; // Level 0, shared with the image cache
+    std::vector<Fl_RGB_Image *> levels; // Levels 1 and up, each half the size of the previous
+
+    // Average 2x2 blocks, odd edges are folded into the last block
+    static PixelBuffer halve(const PixelBuffer &src) {
+        PixelBuffer dst(std::max(1, src.w / 2), std::max(1, src.h / 2));
+        for (int y = 0; y < dst.h; y++) {
+            const unsigned char *r0 = src.row(std::min(2 * y, src.h - 1));
+            const unsigned char *r1 = src.row(std::min(2 * y + 1, src.h - 1));
+            unsigned char *out = dst.row(y);
+            for (int x = 0; x < dst.w; x++) {
+                int x0 = std::min(2 * x, src.w - 1) * 4;
+                int x1 = std::min(2 * x + 1, src.w - 1) * 4;
+                for (int c = 0; c < 4; c++) {
+                    out[4 * x + c] = (unsigned char)((r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c] + 2) >> 2);
+                }
+            }
+        }
+        return dst;
+    }
+
+public:
+    // Constructor to build every level down to 1x1 pixel
+    MipPyramid(std::shared_ptr<Fl_Image> image) {
+        source = image;
+        if (!source || source->w() <= 1 || source->h() <= 1) return;
+
+        PixelBuffer current = PixelBuffer::fromImage(source.get());
+        if (current.empty()) return;
+        while (current.w > 1 || current.h > 1) {
+            current = halve(current);
+            levels.push_back(current.toImage());
+        }
+    }
+
+    // Get the pyramid of an image, building it only if no widget holds one already
+    static std::shared_ptr<MipPyramid> of(std::shared_ptr<Fl_Image> image) {
+        static std::map<const Fl_Image *, std::weak_ptr<MipPyramid>> registry;
+        static std::mutex lock;
+
+        std::lock_guard<std::mutex> guard(lock);
+        for (std::map<const Fl_Image *, std::weak_ptr<MipPyramid>>::iterator it = registry.begin(); it != registry.end();) {
+            if (it->second.expired()) {
+                it = registry.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        std::shared_ptr<MipPyramid> pyramid = registry[image.get()].lock();
+        if (!pyramid) {
+            pyramid = std::make_shared<MipPyramid>(image);
+            registry[image.get()] = pyramid;
+        }
+        return pyramid;
+    }
+
+    // Get the number of levels, including the source
+    int count() const {
+        return (int)levels.size() + 1;
+    }
+
+    // Get a level, 0 is the source image
+    Fl_Image *level(int index) const {
+        if (index == 0) return source.get();
+        return levels[index - 1];
+    }
+
+    // Get the index of the smallest level that covers a w x h target
+    int levelFor(int w, int h) const {
+        int index = 0;
+        while (index + 1 < count() && level(index + 1)->w() >= w && level(index + 1)->h() >= h) {
+            index++;
+        }
+        return index;
+    }
+
+    // Create a new image of exactly w x h from the best level, the caller owns it
+    Fl_Image *scaled(int w, int h, RESAMPLE_FILTER filter = RESAMPLE_BICUBIC) const {
+        Fl_Image *from = level(levelFor(w, h));
+        Fl_Image *result = Resampler::resize(from, w, h, filter);
+        if (!result) result = from->copy(w, h);
+        return result;
+    }
+
+    // Get the number of bytes held by the generated levels
+    size_t bytes() const {
+        size_t total = 0;
+        for (size_t i = 0; i < levels.size(); i++) {
+            total += (size_t)levels[i]->w() * levels[i]->h() * 4;
+        }
+        return total;
+    }
+
+    // Destructor to delete the generated levels
+    ~MipPyramid() {
+        for (size_t i = 0; i < levels.size(); i++) {
+            delete levels[i];
+        }
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef BOBCAT_UI_PIXEL_BUFFER
+#define BOBCAT_UI_PIXEL_BUFFER
+
+#include "bobcat_ui.h"
+#include <FL/Fl_Image.H>
+#include <cstring>
+#include <vector>
+
+namespace bobcat {
+
+/**
+ * @class PixelBuffer
+ * @brief Tightly packed 8-bit RGBA pixels, top row first.
+ *
+ * FLTK images come with 1 to 4 channels and an optional line stride. The
+ * pixel processing code in bobcat works on this single layout instead and
+ * converts at the edges with fromImage() and toImage().
+ */
+class PixelBuffer {
+public:
+    int w; // Width in pixels
+    int h; // Height in pixels
+    std::vector<unsigned char> rgba; // w * h * 4 bytes
+
+    // Constructor to create an empty buffer
+    PixelBuffer() {
+        w = 0;
+        h = 0;
+    }
+
+    // Constructor to create a transparent buffer of the given size
+    PixelBuffer(int width, int height) {
+        w = width;
+        h = height;
+        rgba.assign((size_t)w * h * 4, 0);
+    }
+
+    // Check if the buffer holds no pixels
+    bool empty() const {
+        return w <= 0 || h <= 0;
+    }
+
+    // Get a pointer to the first byte of a row
+    unsigned char *row(int y) {
+        return &rgba[(size_t)y * w * 4];
+    }
+
+    const unsigned char *row(int y) const {
+        return &rgba[(size_t)y * w * 4];
+    }
+
+    // Get the number of bytes held by the buffer
+    size_t bytes() const {
+        return rgba.size();
+    }
+
+    // Convert an FLTK image of any depth to RGBA, returns an empty buffer for unsupported images
+    static PixelBuffer fromImage(const Fl_Image *img) {
+        PixelBuffer out;
+        if (!img || img->w() <= 0 || img->h() <= 0 || img->count() != 1 || img->d() < 1 || img->d() > 4) {
+            return out;
+        }
+        const unsigned char *src = (const unsigned char *)img->data()[0];
+        if (!src) return out;
+
+        out = PixelBuffer(img->w(), img->h());
+        int d = img->d();
+        int ld = img->ld() ? img->ld() : img->w() * d;
+        for (int y = 0; y < out.h; y++) {
+            const unsigned char *s = src + (size_t)y * ld;
+            unsigned char *t = out.row(y);
+            if (d == 4) {
+                memcpy(t, s, (size_t)out.w * 4);
+                continue;
+            }
+            for (int x = 0; x < out.w; x++, s += d, t += 4) {
+                if (d >= 3) {
+                    t[0] = s[0];
+                    t[1] = s[1];
+                    t[2] = s[2];
+                    t[3] = 255;
+                } else {
+                    t[0] = t[1] = t[2] = s[0];
+                    t[3] = d == 2 ? s[1] : 255;
+                }
+            }
+        }
+        return out;
+    }
+
+    // Create an FLTK image that owns a copy of the pixels
+    Fl_RGB_Image *toImage() const {
+        unsigned char *copy = new unsigned char[rgba.size()];
+        memcpy(copy, rgba.data(), rgba.size());
+        Fl_RGB_Image *img = new Fl_RGB_Image(copy, w, h, 4);
+        img->alloc_array = 1;
+        return img;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef BOBCAT_UI_PNG_WRITER
+#define BOBCAT_UI_PNG_WRITER
+
+#include "bobcat_ui.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace bobcat {
+
+/**
+ * @class PNGWriter
+ * @brief Encodes 8-bit gray, RGB or RGBA pixels as PNG files.
+ *
+ * FLTK can decode PNGs but not write them. The writer stores the image data
+ * in uncompressed deflate blocks, which keeps it free of a zlib dependency and
+ * fast enough for frame dumps, test references and thumbnail caches.
+ */
+class PNGWriter {
+    // CRC-32 as used by PNG chunks
+    static unsigned int crc(const unsigned char *data, size_t len, unsigned int c = 0xffffffffu) {
+        static const std::vector<unsigned int> table = [] {
+            std::vector<unsigned int> t(256);
+            for (unsigned int n = 0; n < 256; n++) {
+                unsigned int v = n;
+                for (int k = 0; k < 8; k++) v = (v & 1) ? 0xedb88320u ^ (v >> 1) : v >> 1;
+                t[n] = v;
+            }
+            return t;
+        }();
+        for (size_t i = 0; i < len; i++) c = table[(c ^ data[i]) & 0xff] ^ (c >> 8);
+        return c;
+    }
+
+    // Append a 32-bit big endian value
+    static void put32(std::vector<unsigned char> &out, unsigned int v) {
+        out.push_back((v >> 24) & 0xff);
+        out.push_back((v >> 16) & 0xff);
+        out.push_back((v >> 8) & 0xff);
+        out.push_back(v & 0xff);
+    }
+
+    // Append a chunk with its length and checksum
+    static void chunk(std::vector<unsigned char> &out, const char *type, const std::vector<unsigned char> &data) {
+        put32(out, (unsigned int)data.size());
+        size_t start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+        put32(out, crc(&out[start], out.size() - start) ^ 0xffffffffu);
+    }
+
+public:
+    // Encode pixels to PNG bytes, channels is 1 (gray), 3 (RGB) or 4 (RGBA), stride 0 means packed rows
+    static std::vector<unsigned char> encode(const unsigned char *pixels, int w, int h, int channels, int stride = 0) {
+        std::vector<unsigned char> out;
+        if (w <= 0 || h <= 0 || (channels != 1 && channels != 3 && channels != 4)) return out;
+        if (stride == 0) stride = w * channels;
+
+        static const unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+        out.insert(out.end(), signature, signature + 8);
+
+        std::vector<unsigned char> header;
+        put32(header, (unsigned int)w);
+        put32(header, (unsigned int)h);
+        header.push_back(8);
+        header.push_back(channels == 1 ? 0 : (channels == 3 ? 2 : 6));
+        header.push_back(0);
+        header.push_back(0);
+        header.push_back(0);
+        chunk(out, "IHDR", header);
+
+        // Raw scanlines, each prefixed with filter type 0
+        size_t rowBytes = (size_t)w * channels;
+        std::vector<unsigned char> raw;
+        raw.reserve((rowBytes + 1) * h);
+        for (int y = 0; y < h; y++) {
+            raw.push_back(0);
+            const unsigned char *row = pixels + (size_t)y * stride;
+            raw.insert(raw.end(), row, row + rowBytes);
+        }
+
+        // zlib stream made of stored blocks
+        std::vector<unsigned char> z;
+        z.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+        z.push_back(0x78);
+        z.push_back(0x01);
+        size_t pos = 0;
+        do {
+            size_t len = raw.size() - pos;
+            if (len > 65535) len = 65535;
+            z.push_back(pos + len == raw.size() ? 1 : 0);
+            z.push_back(len & 0xff);
+            z.push_back((len >> 8) & 0xff);
+            z.push_back(~len & 0xff);
+            z.push_back((~len >> 8) & 0xff);
+            z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+            pos += len;
+        } while (pos < raw.size());
+
+        unsigned int a = 1, b = 0;
+        for (size_t i = 0; i < raw.size(); i++) {
+            a = (a + raw[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        put32(z, (b << 16) | a);
+        chunk(out, "IDAT", z);
+
+        chunk(out, "IEND", std::vector<unsigned char>());
+        return out;
+    }
+
+    // Write pixels to a PNG file, returns false if the file could not be written
+    static bool write(std::string filename, const unsigned char *pixels, int w, int h, int channels, int stride = 0) {
+        std::vector<unsigned char> bytes = encode(pixels, w, h, channels, stride);
+        if (bytes.empty()) return false;
+        FILE *f = fopen(filename.c_str(), "wb");
+        if (!f) return false;
+        size_t written = fwrite(bytes.data(), 1, bytes.size(), f);
+        bool ok = fclose(f) == 0 && written == bytes.size();
+        return ok;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,315 @@
+#ifndef BOBCAT_UI_POLYGON_BUTTON
+#define BOBCAT_UI_POLYGON_BUTTON
+
+#include "bobcat_ui.h"
+#include "callbacks.h"
+#include "label_pool.h"
+#include "render_cache.h"
+#include "text_layout.h"
+#include <FL/Enumerations.H>
+#include <FL/Fl.H>
+#include <FL/Fl_Button.H>
+#include <FL/Fl_Group.H>
+#include <FL/fl_draw.H>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace bobcat {
+
+// A corner of a polygon button's shape, from (-1, -1) at the top left of the button to (1, 1) at the bottom right
+struct PolygonVertex {
+    double x;
+    double y;
+};
+
+/**
+ * @class PolygonButton
+ * @brief A button drawn as a polygon that only takes clicks inside the polygon.
+ *
+ * The shape is a list of vertices scaled to the button's size. Scaled
+ * outlines are shared by every button with the same shape and size and only
+ * computed when a new size shows up, so drawing and hit testing never call
+ * cos or sin. FL_PUSH, FL_ENTER and FL_MOVE outside the polygon are refused,
+ * which lets the group offer them to the neighbor whose polygon contains the
+ * pointer.
+ */
+class PolygonButton : public Fl_Button {
+    // A shape scaled to one button size, in pixels from the button's top left corner
+    struct Outline {
+        std::shared_ptr<const std::vector<PolygonVertex>> shape; // Keeps the shape alive while its key is in use
+        std::vector<int> x;
+        std::vector<int> y;
+    };
+
+    typedef std::pair<const std::vector<PolygonVertex> *, std::pair<int, int>> OutlineKey;
+
+    std::shared_ptr<const std::vector<PolygonVertex>> shape; // Unit vertices
+    std::shared_ptr<const Outline> outline; // Vertices at the current size
+    int outlineW, outlineH; // Size the outline was scaled to
+    std::unique_ptr<RenderCache> renderCache; // Offscreen copy of the button, see cache()
+
+    // Get the registry of live outlines by shape and size
+    static std::map<OutlineKey, std::weak_ptr<const Outline>> &outlines() {
+        static std::map<OutlineKey, std::weak_ptr<const Outline>> table;
+        return table;
+    }
+
+    // Get the outline of a shape at a size, shared with other buttons of that shape and size
+    static std::shared_ptr<const Outline> scaled(const std::shared_ptr<const std::vector<PolygonVertex>> &shape, int w, int h) {
+        std::map<OutlineKey, std::weak_ptr<const Outline>> &table = outlines();
+        OutlineKey key(shape.get(), std::make_pair(w, h));
+        std::shared_ptr<const Outline> found = table[key].lock();
+        if (found) return found;
+
+        for (std::map<OutlineKey, std::weak_ptr<const Outline>>::iterator it = table.begin(); it != table.end();) {
+            if (it->second.expired() && it->first != key) {
+                it = table.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        std::shared_ptr<Outline> made = std::make_shared<Outline>();
+        made->shape = shape;
+        for (size_t i = 0; i < shape->size(); i++) {
+            made->x.push_back((int)(w / 2 + (w / 2) * (*shape)[i].x));
+            made->y.push_back((int)(h / 2 + (h / 2) * (*shape)[i].y));
+        }
+        table[key] = made;
+        return made;
+    }
+
+    // Get the outline for the current size
+    const Outline &current() {
+        if (!outline || outlineW != w() || outlineH != h()) {
+            outline = scaled(shape, w(), h());
+            outlineW = w();
+            outlineH = h();
+        }
+        return *outline;
+    }
+
+    // Handle events for the polygon button
+    int handle(int event) {
+        if ((event == FL_PUSH || event == FL_ENTER || event == FL_MOVE) && !inside(Fl::event_x(), Fl::event_y())) {
+            return 0;
+        }
+        int ret = Fl_Button::handle(event);
+
+        if (event == FL_ENTER){
+            CallbackTable::fire(this, EVENT_ENTER);
+        }
+        if (event == FL_LEAVE){
+            CallbackTable::fire(this, EVENT_LEAVE);
+        }
+        return ret;
+    }
+
+    // Draw the polygon and the label at (x, y)
+    void paint(int x, int y) {
+        const Outline &o = current();
+
+        fl_color(Fl_Button::color());
+        fl_begin_polygon();
+        for (size_t i = 0; i < o.x.size(); i++) fl_vertex(x + o.x[i], y + o.y[i]);
+        fl_end_polygon();
+
+        // Draw the border
+        fl_color(Fl_Button::labelcolor());
+        fl_begin_loop();
+        for (size_t i = 0; i < o.x.size(); i++) fl_vertex(x + o.x[i], y + o.y[i]);
+        fl_end_loop();
+
+        // Draw the label in the border color, measured once through the shared layout cache
+        TextLayoutCache::shared().draw(label(), Fl_Button::labelfont(), Fl_Button::labelsize(), x, y, w(), h(), Fl_Button::align());
+    }
+
+protected:
+    // Paint the button again on its next draw
+    void invalidateCache() {
+        if (renderCache) renderCache->invalidate();
+    }
+
+    // Constructor for buttons of a shared shape
+    PolygonButton(int x, int y, int w, int h, std::shared_ptr<const std::vector<PolygonVertex>> shape, std::string caption): Fl_Button(x, y, w, h, caption.c_str()) {
+        this->shape = shape;
+        outlineW = 0;
+        outlineH = 0;
+        LabelPool::assign(this, caption);
+    }
+
+public:
+    // Constructor to initialize a button with a custom shape, vertices in order around the outline
+    PolygonButton(int x, int y, int w, int h, const std::vector<PolygonVertex> &path, std::string caption = ""): PolygonButton(x, y, w, h, std::make_shared<const std::vector<PolygonVertex>>(path), caption) {}
+
+    // Get the vertices of a regular polygon with the first one at angle, in radians from the right
+    // Tables are made once per number of sides and angle and shared
+    static std::shared_ptr<const std::vector<PolygonVertex>> regular(int sides, double angle = 0) {
+        static std::map<std::pair<int, double>, std::shared_ptr<const std::vector<PolygonVertex>>> tables;
+        sides = std::max(3, sides);
+        std::shared_ptr<const std::vector<PolygonVertex>> &table = tables[std::make_pair(sides, angle)];
+        if (!table) {
+            std::vector<PolygonVertex> v(sides);
+            for (int i = 0; i < sides; ++i) {
+                double a = angle + 2 * M_PI / sides * i;
+                v[i].x = cos(a);
+                v[i].y = sin(a);
+            }
+            table = std::make_shared<const std::vector<PolygonVertex>>(v);
+        }
+        return table;
+    }
+
+    // Check if a window point is inside the polygon
+    bool inside(int px, int py) {
+        const Outline &o = current();
+        px -= x();
+        py -= y();
+        // Count the edges crossed by a ray to the right, sampling at pixel centers
+        double cx = px + 0.5, cy = py + 0.5;
+        bool in = false;
+        size_t n = o.x.size();
+        for (size_t i = 0, j = n - 1; i < n; j = i++) {
+            if ((o.y[i] > cy) == (o.y[j] > cy)) continue;
+            double at = o.x[i] + (cy - o.y[i]) * (o.x[j] - o.x[i]) / (double)(o.y[j] - o.y[i]);
+            if (cx < at) in = !in;
+        }
+        return in;
+    }
+
+    // Override the draw method to draw the button, from its cache if it has one
+    void draw() override {
+        if (!renderCache) {
+            RenderStats::shared().rendered(w(), h());
+            paint(x(), y());
+            return;
+        }
+        renderCache->draw(this, [this]() {
+            paint(0, 0);
+        });
+    }
+
+    // Keep a rendered copy of the button and copy it on redraws until one of its properties changes
+    // The area around the polygon is filled with the parent's color, see RenderCache
+    void cache(bool enabled) {
+        if (enabled == cached()) return;
+        renderCache.reset(enabled ? new RenderCache() : nullptr);
+        redraw();
+    }
+
+    // Check if the button keeps a rendered copy
+    bool cached() const {
+        return renderCache != nullptr;
+    }
+
+    // Get the label of the button
+    std::string_view label() const {
+        return LabelPool::view(this);
+    }
+
+    // Set the label of the button
+    void label(std::string_view s) {
+        if (LabelPool::assign(this, s)) invalidateCache();
+    }
+
+    // Set the onClick callback function
+    void onClick(std::function<void(bobcat::Widget *)> cb){
+        CallbackTable::set(this, EVENT_CLICK, cb);
+        callback([](bobcat::Widget* sender, void* self){
+            PolygonButton* butt = (PolygonButton*) self;
+            CallbackTable::fire(butt, EVENT_CLICK);
+        }, this);
+    }
+
+    // Set the onEnter callback function
+    void onEnter(std::function<void(bobcat::Widget *)> cb){
+        CallbackTable::set(this, EVENT_ENTER, cb);
+    }
+
+    // Set the onLeave callback function
+    void onLeave(std::function<void(bobcat::Widget *)> cb){
+        CallbackTable::set(this, EVENT_LEAVE, cb);
+    }
+
+    // Set the alignment of the button
+    void align(Fl_Align alignment){
+        Fl_Button::align(alignment);
+        invalidateCache();
+        parent()->redraw();
+    }
+
+    // Get the label size of the button
+    Fl_Fontsize labelsize() {
+        return Fl_Button::labelsize();
+    }
+
+    // Set the label size of the button
+    void labelsize(Fl_Fontsize pix) {
+        Fl_Button::labelsize(pix);
+        invalidateCache();
+        parent()->redraw();
+    }
+
+    // Get the label color of the button
+    Fl_Color labelcolor() {
+        return Fl_Button::labelcolor();
+    }
+
+    // Set the label color of the button
+    void labelcolor(Fl_Color color) {
+        Fl_Button::labelcolor(color);
+        invalidateCache();
+        parent()->redraw();
+    }
+
+    // Get the label font of the button
+    Fl_Font labelfont() {
+        return Fl_Button::labelfont();
+    }
+
+    // Set the label font of the button
+    void labelfont(Fl_Font f) {
+        Fl_Button::labelfont(f);
+        invalidateCache();
+        parent()->redraw();
+    }
+
+    // Set the focus to the button
+    void take_focus() {
+        Fl_Button::take_focus();
+    }
+
+    // Destructor to remove the callbacks and release the label of the button
+    ~PolygonButton() {
+        CallbackTable::clear(this);
+        LabelPool::release(this);
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+/**
+ * @class NGonButton
+ * @brief A button drawn as a regular polygon with any number of sides.
+ */
+class NGonButton : public PolygonButton {
+public:
+    // Constructor to initialize the button with position, size, number of sides, and caption
+    // angle turns the polygon, 0 puts a corner on the right
+    NGonButton(int x, int y, int w, int h, int sides, std::string caption = "", double angle = 0): PolygonButton(x, y, w, h, regular(sides, angle), caption) {}
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -0,0 +1,231 @@
+#ifndef BOBCAT_UI_RENDER_CACHE
+#define BOBCAT_UI_RENDER_CACHE
+
+#include "bobcat_ui.h"
+#include "text_layout.h"
+#include <FL/Enumerations.H>
+#include <FL/Fl.H>
+#include <FL/Fl_Group.H>
+#include <FL/Fl_Widget.H>
+#include <FL/fl_draw.H>
+#include <FL/x.H>
+#include <cstdio>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+namespace bobcat {
+
+// Pixels drawn in one frame by widgets that can cache their rendering
+struct FrameDraw {
+    size_t rendered; // Pixels painted by draw code
+    size_t blitted; // Pixels copied from a render cache
+};
+
+/**
+ * @class RenderStats
+ * @brief Overdraw report of the widgets that can cache their rendering.
+ *
+ * TextBox and the polygon buttons count the pixels they paint and the pixels they
+ * copy from their RenderCache. A frame ends when FLTK has flushed and goes back
+ * to waiting for events; frames that drew nothing are not recorded.
+ */
+class RenderStats {
+    FrameDraw current; // Counts of the frame being drawn
+    std::vector<FrameDraw> frames; // Recent frames, oldest first
+    size_t keep; // Number of frames kept
+    bool hooked; // The end of frame check is installed
+
+    RenderStats() {
+        current.rendered = 0;
+        current.blitted = 0;
+        keep = 600;
+        hooked = false;
+    }
+
+    // Close the current frame, called by FLTK before it waits for events
+    static void endFrame(void *data) {
+        RenderStats *self = (RenderStats *)data;
+        if (self->current.rendered == 0 && self->current.blitted == 0) return;
+        self->frames.push_back(self->current);
+        if (self->frames.size() > self->keep) self->frames.erase(self->frames.begin());
+        self->current.rendered = 0;
+        self->current.blitted = 0;
+    }
+
+    // Start closing frames once something is drawn
+    void hook() {
+        if (hooked) return;
+        hooked = true;
+        Fl::add_check(endFrame, this);
+    }
+
+public:
+    // Get the report shared by all widgets
+    static RenderStats &shared() {
+        static RenderStats stats;
+        return stats;
+    }
+
+    // Count pixels painted by draw code
+    void rendered(int w, int h) {
+        hook();
+        current.rendered += (size_t)w * h;
+    }
+
+    // Count pixels copied from a cache
+    void blitted(int w, int h) {
+        hook();
+        current.blitted += (size_t)w * h;
+    }
+
+    // Get the recorded frames, oldest first
+    const std::vector<FrameDraw> &history() const {
+        return frames;
+    }
+
+    // Forget the recorded frames
+    void reset() {
+        frames.clear();
+        current.rendered = 0;
+        current.blitted = 0;
+    }
+
+    // Print the pixels rendered and blitted in each recorded frame, with totals
+    void report(std::ostream &out) const {
+        char line[128];
+        snprintf(line, sizeof(line), "%-8s %12s %12s\n", "Frame", "rendered", "blitted");
+        out << line;
+        size_t rendered = 0, blitted = 0;
+        for (size_t i = 0; i < frames.size(); i++) {
+            snprintf(line, sizeof(line), "%-8zu %12zu %12zu\n", i, frames[i].rendered, frames[i].blitted);
+            out << line;
+            rendered += frames[i].rendered;
+            blitted += frames[i].blitted;
+        }
+        snprintf(line, sizeof(line), "%-8s %12zu %12zu\n", "Total", rendered, blitted);
+        out << line;
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+/**
+ * @class RenderCache
+ * @brief An offscreen copy of a widget that is painted once and then copied.
+ *
+ * The widget paints into the offscreen only when it is invalidated or its
+ * size, color, box, image, label type, label color, label font, label size,
+ * active state or its parent's color changed, or fonts were changed through
+ * TextLayoutCache; every other redraw, such as one caused by the parent,
+ * copies the offscreen to the window. Pixels the widget leaves unpainted,
+ * like the corners around a hexagon, are filled with the parent's color, so
+ * cached widgets should sit on a plain background.
+ */
+class RenderCache {
+    Fl_Offscreen offscreen; // Cached pixels, 0 until first drawn
+    int cw, ch; // Size of the offscreen
+    bool valid; // The offscreen matches the widget
+    Fl_Color background; // Parent color the offscreen was painted on
+    Fl_Color color; // Widget color the offscreen was painted with
+    Fl_Boxtype box; // Widget box the offscreen was painted with
+    Fl_Image *image; // Widget image the offscreen was painted with
+    bool active; // Widget was active, with its parents, when the offscreen was painted
+    Fl_Labeltype labelType; // Widget label type the offscreen was painted with
+    Fl_Color labelColor; // Widget label color the offscreen was painted with
+    Fl_Font labelFont; // Widget label font the offscreen was painted with
+    Fl_Fontsize labelSize; // Widget label size the offscreen was painted with
+    unsigned long textGeneration; // Text layouts the offscreen was painted with
+
+    // Check if the offscreen was painted with the widget's current look on a background
+    bool matches(Fl_Widget *widget, Fl_Color bg) const {
+        return bg == background && widget->color() == color && widget->box() == box && widget->image() == image &&
+               (widget->active_r() != 0) == active && widget->labeltype() == labelType &&
+               widget->labelcolor() == labelColor && widget->labelfont() == labelFont &&
+               widget->labelsize() == labelSize && TextLayoutCache::shared().generation() == textGeneration;
+    }
+
+public:
+    // Constructor to create an empty cache
+    RenderCache() {
+        offscreen = 0;
+        cw = 0;
+        ch = 0;
+        valid = false;
+        background = FL_BACKGROUND_COLOR;
+        color = FL_BACKGROUND_COLOR;
+        box = FL_NO_BOX;
+        image = nullptr;
+        active = true;
+        labelType = FL_NORMAL_LABEL;
+        labelColor = FL_FOREGROUND_COLOR;
+        labelFont = FL_HELVETICA;
+        labelSize = FL_NORMAL_SIZE;
+        textGeneration = 0;
+    }
+
+    // Paint the widget again on its next draw
+    void invalidate() {
+        valid = false;
+    }
+
+    // Check if the next draw can copy the offscreen
+    bool current() const {
+        return valid;
+    }
+
+    // Draw a widget from the cache, painting it first if needed
+    // paint draws the widget with its top left corner at (0, 0)
+    void draw(Fl_Widget *widget, std::function<void()> paint) {
+        int w = widget->w(), h = widget->h();
+        if (w <= 0 || h <= 0) return;
+        Fl_Color bg = widget->parent() ? widget->parent()->color() : FL_BACKGROUND_COLOR;
+
+        if (offscreen && (w != cw || h != ch)) {
+            fl_delete_offscreen(offscreen);
+            offscreen = 0;
+        }
+        if (!offscreen) {
+            offscreen = fl_create_offscreen(w, h);
+            cw = w;
+            ch = h;
+            valid = false;
+        }
+
+        if (!valid || !matches(widget, bg)) {
+            fl_begin_offscreen(offscreen);
+            fl_color(bg);
+            fl_rectf(0, 0, w, h);
+            paint();
+            fl_end_offscreen();
+            valid = true;
+            background = bg;
+            color = widget->color();
+            box = widget->box();
+            image = widget->image();
+            active = widget->active_r() != 0;
+            labelType = widget->labeltype();
+            labelColor = widget->labelcolor();
+            labelFont = widget->labelfont();
+            labelSize = widget->labelsize();
+            textGeneration = TextLayoutCache::shared().generation();
+            RenderStats::shared().rendered(w, h);
+        } else {
+            RenderStats::shared().blitted(w, h);
+        }
+        fl_copy_offscreen(widget->x(), widget->y(), w, h, offscreen, 0, 0);
+    }
+
+    // Destructor to free the offscreen
+    ~RenderCache() {
+        if (offscreen) fl_delete_offscreen(offscreen);
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -0,0 +1,299 @@
+#ifndef BOBCAT_UI_RESAMPLE
+#define BOBCAT_UI_RESAMPLE
+
+#include "bobcat_ui.h"
+#include "pixel_buffer.h"
+#include "worker_pool.h"
+#include <FL/Fl_Image.H>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace bobcat {
+
+// Filters available to Resampler
+enum RESAMPLE_FILTER {RESAMPLE_BILINEAR, RESAMPLE_BICUBIC, RESAMPLE_LANCZOS};
+
+/**
+ * @class Resampler
+ * @brief Separable image scaling with bilinear, bicubic and Lanczos-3 filters.
+ *
+ * When shrinking, the filter is widened by the scale factor so every source
+ * pixel contributes, which avoids the aliasing of nearest-neighbour copies.
+ * Colors are filtered with premultiplied alpha so transparent pixels do not
+ * bleed dark fringes. The horizontal pass filters one RGBA pixel per SSE
+ * register, the vertical pass runs over whole rows with AVX or SSE, and both
+ * fall back to scalar code on other targets. Output rows are made in bands
+ * that filter only the source rows they read, so the scratch memory grows
+ * with the output width and the scale rather than the source height, and
+ * large images run their bands on the shared WorkerPool.
+ */
+class Resampler {
+    // Filter taps of one output coordinate
+    struct Taps {
+        int first; // First source index
+        int count; // Number of weights
+        int offset; // Position of the first weight in the weight table
+    };
+
+    // Filter radius in source pixels at scale 1
+    static float radius(RESAMPLE_FILTER filter) {
+        switch (filter) {
+            case RESAMPLE_BILINEAR: return 1.0f;
+            case RESAMPLE_BICUBIC: return 2.0f;
+            case RESAMPLE_LANCZOS: return 3.0f;
+        }
+        return 1.0f;
+    }
+
+    // Evaluate a filter kernel
+    static float kernel(RESAMPLE_FILTER filter, float x) {
+        x = std::fabs(x);
+        switch (filter) {
+            case RESAMPLE_BILINEAR:
+                return x < 1.0f ? 1.0f - x : 0.0f;
+            case RESAMPLE_BICUBIC: {
+                // Catmull-Rom spline (a = -0.5)
+                const float a = -0.5f;
+                if (x < 1.0f) return ((a + 2.0f) * x - (a + 3.0f)) * x * x + 1.0f;
+                if (x < 2.0f) return ((a * x - 5.0f * a) * x + 8.0f * a) * x - 4.0f * a;
+                return 0.0f;
+            }
+            case RESAMPLE_LANCZOS: {
+                if (x < 1e-6f) return 1.0f;
+                if (x >= 3.0f) return 0.0f;
+                float px = (float)M_PI * x;
+                return 3.0f * sinf(px) * sinf(px / 3.0f) / (px * px);
+            }
+        }
+        return 0.0f;
+    }
+
+    // Build the normalized weights mapping srcSize samples to dstSize samples,
+    // for the count output samples starting at from
+    static void weights(RESAMPLE_FILTER filter, int srcSize, int dstSize, int from, int count, std::vector<Taps> &taps, std::vector<float> &table) {
+        float scale = (float)dstSize / srcSize;
+        float stretch = scale < 1.0f ? 1.0f / scale : 1.0f;
+        float support = radius(filter) * stretch;
+
+        taps.resize(count);
+        table.clear();
+        for (int i = from; i < from + count; i++) {
+            float center = (i + 0.5f) / scale - 0.5f;
+            int first = std::max(0, (int)ceilf(center - support));
+            int last = std::min(srcSize - 1, (int)floorf(center + support));
+            if (last < first) first = last = std::min(srcSize - 1, std::max(0, (int)(center + 0.5f)));
+
+            Taps t;
+            t.first = first;
+            t.count = last - first + 1;
+            t.offset = (int)table.size();
+            float sum = 0.0f;
+            for (int k = first; k <= last; k++) {
+                float w = kernel(filter, (k - center) / stretch);
+                table.push_back(w);
+                sum += w;
+            }
+            if (sum == 0.0f) sum = 1.0f;
+            for (int k = 0; k < t.count; k++) table[t.offset + k] /= sum;
+            taps[i - from] = t;
+        }
+    }
+
+    // Load a source pixel as premultiplied floats
+    static void loadPixel(const unsigned char *p, int d, float out[4]) {
+        float a = 255.0f;
+        if (d >= 3) {
+            out[0] = p[0];
+            out[1] = p[1];
+            out[2] = p[2];
+            if (d == 4) a = p[3];
+        } else {
+            out[0] = out[1] = out[2] = p[0];
+            if (d == 2) a = p[1];
+        }
+        float m = a / 255.0f;
+        out[0] *= m;
+        out[1] *= m;
+        out[2] *= m;
+        out[3] = a;
+    }
+
+    // Horizontal pass of one source row into a row of premultiplied floats
+    static void filterRow(const unsigned char *src, int d, const std::vector<Taps> &taps, const std::vector<float> &table, float *out) {
+        int dw = (int)taps.size();
+#if defined(__SSE2__)
+        if (d == 4) {
+            const __m128i zero = _mm_setzero_si128();
+            for (int i = 0; i < dw; i++) {
+                const Taps &t = taps[i];
+                const float *w = &table[t.offset];
+                const unsigned char *p = src + (size_t)t.first * 4;
+                __m128 acc = _mm_setzero_ps();
+                for (int k = 0; k < t.count; k++, p += 4) {
+                    int raw;
+                    memcpy(&raw, p, 4);
+                    __m128i px = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(raw), zero), zero);
+                    // Weight rgb by alpha / 255 to premultiply, weight alpha as is
+                    float aw = p[3] * (1.0f / 255.0f) * w[k];
+                    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(px), _mm_set_ps(w[k], aw, aw, aw)));
+                }
+                _mm_storeu_ps(out + 4 * i, acc);
+            }
+            return;
+        }
+#endif
+        for (int i = 0; i < dw; i++) {
+            const Taps &t = taps[i];
+            const float *w = &table[t.offset];
+            float acc[4] = {0, 0, 0, 0};
+            for (int k = 0; k < t.count; k++) {
+                float px[4];
+                loadPixel(src + (size_t)(t.first + k) * d, d, px);
+                for (int c = 0; c < 4; c++) acc[c] += px[c] * w[k];
+            }
+            for (int c = 0; c < 4; c++) out[4 * i + c] = acc[c];
+        }
+    }
+
+    // Vertical pass: weighted sum of float rows into one float row
+    static void sumRows(const std::vector<const float *> &rows, const float *w, int n, float *out) {
+        int i = 0;
+#if defined(__AVX__)
+        for (; i + 8 <= n; i += 8) {
+            __m256 acc = _mm256_setzero_ps();
+            for (size_t k = 0; k < rows.size(); k++) {
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(rows[k] + i), _mm256_set1_ps(w[k])));
+            }
+            _mm256_storeu_ps(out + i, acc);
+        }
+#endif
+#if defined(__SSE2__)
+        for (; i + 4 <= n; i += 4) {
+            __m128 acc = _mm_setzero_ps();
+            for (size_t k = 0; k < rows.size(); k++) {
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(rows[k] + i), _mm_set1_ps(w[k])));
+            }
+            _mm_storeu_ps(out + i, acc);
+        }
+#endif
+        for (; i < n; i++) {
+            float acc = 0.0f;
+            for (size_t k = 0; k < rows.size(); k++) acc += rows[k][i] * w[k];
+            out[i] = acc;
+        }
+    }
+
+    // Convert a row of premultiplied floats back to RGBA bytes
+    static void storeRow(const float *in, int w, unsigned char *out) {
+        for (int x = 0; x < w; x++) {
+            float a = std::min(255.0f, std::max(0.0f, in[4 * x + 3]));
+            float m = a > 0.0f ? 255.0f / a : 0.0f;
+            for (int c = 0; c < 3; c++) {
+                float v = in[4 * x + c] * m;
+                out[4 * x + c] = (unsigned char)(std::min(255.0f, std::max(0.0f, v)) + 0.5f);
+            }
+            out[4 * x + 3] = (unsigned char)(a + 0.5f);
+        }
+    }
+
+public:
+    // Scale raw pixels with 1 to 4 channels, stride 0 means packed rows
+    static PixelBuffer resize(const unsigned char *src, int sw, int sh, int d, int stride, int dw, int dh, RESAMPLE_FILTER filter = RESAMPLE_BICUBIC) {
+        return resize(src, sw, sh, d, stride, dw, dh, 0, 0, dw, dh, filter);
+    }
+
+    // Make only the rect (rx, ry, rw, rh) of raw pixels scaled to dw by dh, with the pixels a whole resize has there
+    // Only the source pixels the rect reads are filtered, so a small part of a huge scale stays cheap
+    static PixelBuffer resize(const unsigned char *src, int sw, int sh, int d, int stride, int dw, int dh, int rx, int ry, int rw, int rh, RESAMPLE_FILTER filter = RESAMPLE_BICUBIC) {
+        if (!src || sw <= 0 || sh <= 0 || dw <= 0 || dh <= 0 || d < 1 || d > 4) return PixelBuffer();
+        if (rx < 0 || ry < 0 || rw <= 0 || rh <= 0 || rx > dw - rw || ry > dh - rh) return PixelBuffer();
+        if (stride == 0) stride = sw * d;
+
+        std::vector<Taps> hTaps, vTaps;
+        std::vector<float> hTable, vTable;
+        weights(filter, sw, dw, rx, rw, hTaps, hTable);
+        weights(filter, sh, dh, ry, rh, vTaps, vTable);
+        dw = rw;
+        dh = rh;
+
+        // Each band of output rows filters only the source rows its taps read,
+        // so the scratch rows stay bounded however tall the source is
+        PixelBuffer dst(dw, dh);
+        bool parallel = (size_t)dw * dh >= 256u * 256u;
+        const int band = 32;
+
+        int bands = (dh + band - 1) / band;
+        auto run = [&](int b) {
+            int y0 = b * band, y1 = std::min(dh, y0 + band);
+            int rowFirst = vTaps[y0].first, rowLast = rowFirst;
+            for (int y = y0; y < y1; y++) {
+                rowFirst = std::min(rowFirst, vTaps[y].first);
+                rowLast = std::max(rowLast, vTaps[y].first + vTaps[y].count - 1);
+            }
+            std::vector<float> temp((size_t)(rowLast - rowFirst + 1) * dw * 4);
+            for (int r = rowFirst; r <= rowLast; r++) {
+                filterRow(src + (size_t)r * stride, d, hTaps, hTable, &temp[(size_t)(r - rowFirst) * dw * 4]);
+            }
+
+            std::vector<const float *> rows;
+            std::vector<float> line((size_t)dw * 4);
+            for (int y = y0; y < y1; y++) {
+                const Taps &t = vTaps[y];
+                rows.resize(t.count);
+                for (int k = 0; k < t.count; k++) {
+                    rows[k] = &temp[(size_t)(t.first + k - rowFirst) * dw * 4];
+                }
+                sumRows(rows, &vTable[t.offset], dw * 4, line.data());
+                storeRow(line.data(), dw, dst.row(y));
+            }
+        };
+
+        if (parallel) {
+            WorkerPool::shared().parallelFor(bands, run);
+        } else {
+            for (int b = 0; b < bands; b++) run(b);
+        }
+        return dst;
+    }
+
+    // Scale an RGBA buffer
+    static PixelBuffer resize(const PixelBuffer &src, int dw, int dh, RESAMPLE_FILTER filter = RESAMPLE_BICUBIC) {
+        if (src.empty()) return PixelBuffer();
+        return resize(src.rgba.data(), src.w, src.h, 4, 0, dw, dh, filter);
+    }
+
+    // Make only the rect (rx, ry, rw, rh) of an RGBA buffer scaled to dw by dh
+    static PixelBuffer resize(const PixelBuffer &src, int dw, int dh, int rx, int ry, int rw, int rh, RESAMPLE_FILTER filter = RESAMPLE_BICUBIC) {
+        if (src.empty()) return PixelBuffer();
+        return resize(src.rgba.data(), src.w, src.h, 4, 0, dw, dh, rx, ry, rw, rh, filter);
+    }
+
+    // Scale an FLTK image into a new image owned by the caller, nullptr if the image has no pixel data
+    static Fl_RGB_Image *resize(const Fl_Image *src, int dw, int dh, RESAMPLE_FILTER filter = RESAMPLE_BICUBIC) {
+        if (!src || src->count() != 1 || !src->data() || dw <= 0 || dh <= 0) return nullptr;
+        PixelBuffer out = resize((const unsigned char *)src->data()[0], src->w(), src->h(), src->d(), src->ld(), dw, dh, filter);
+        if (out.empty()) return nullptr;
+        return out.toImage();
+    }
+
+    // Make only the rect (rx, ry, rw, rh) of an FLTK image scaled to dw by dh, in a new image owned by the caller
+    static Fl_RGB_Image *resize(const Fl_Image *src, int dw, int dh, int rx, int ry, int rw, int rh, RESAMPLE_FILTER filter = RESAMPLE_BICUBIC) {
+        if (!src || src->count() != 1 || !src->data()) return nullptr;
+        PixelBuffer out = resize((const unsigned char *)src->data()[0], src->w(), src->h(), src->d(), src->ld(), dw, dh, rx, ry, rw, rh, filter);
+        if (out.empty()) return nullptr;
+        return out.toImage();
+    }
+};
+
+}
+
+#endif
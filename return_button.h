@@ -2,37 +2,26 @@
 #define BOBCAT_UI_RETURN_BUTTON
 
 #include "bobcat_ui.h"
+#include "callbacks.h"
+#include "label_pool.h"
 #include <FL/Fl_Return_Button.H>
 #include <string>
+#include <string_view>
 #include <functional>
 
 namespace bobcat {
 
 // ReturnButton class inheriting from Fl_Return_Button
 class ReturnButton: public Fl_Return_Button {
-    std::string caption; // Caption of the return button
-
-    // Callback functions for various events
-    std::function<void(bobcat::Widget *)> onClickCb;
-    std::function<void(bobcat::Widget *)> onEnterCb;
-    std::function<void(bobcat::Widget *)> onLeaveCb;
-
-    // Initialize the callback functions to nullptr
-    void init() {
-        onClickCb = nullptr;
-        onEnterCb = nullptr;
-        onLeaveCb = nullptr;
-    }
-
     // Handle events for the return button
     int handle(int event) {
         int ret = Fl_Return_Button::handle(event);
 
         if (event == FL_ENTER) {
-            if (onEnterCb) onEnterCb(this);
+            CallbackTable::fire(this, EVENT_ENTER);
         }
         if (event == FL_LEAVE) {
-            if (onLeaveCb) onLeaveCb(this);
+            CallbackTable::fire(this, EVENT_LEAVE);
         }
         return ret;
     }
@@ -40,39 +29,36 @@ class ReturnButton: public Fl_Return_Button {
 public:
     // Constructor to initialize the return button with position, size, and caption
     ReturnButton(int x, int y, int w, int h, std::string caption = ""): Fl_Return_Button(x, y, w, h, caption.c_str()) {
-        init();
-        this->caption = caption;
-        Fl_Return_Button::copy_label(caption.c_str());
+        LabelPool::assign(this, caption);
     }
 
     // Get the label of the return button
-    std::string label() const {
-        return caption;
+    std::string_view label() const {
+        return LabelPool::view(this);
     }
 
     // Set the label of the return button
-    void label(std::string s) {
-        Fl_Return_Button::copy_label(s.c_str());
-        caption = s;
+    void label(std::string_view s) {
+        LabelPool::assign(this, s);
     }
 
     // Set the onClick callback function
     void onClick(std::function<void(bobcat::Widget *)> cb) {
-        onClickCb = cb;
+        CallbackTable::set(this, EVENT_CLICK, cb);
         callback([](bobcat::Widget* sender, void* self) {
             ReturnButton* butt = (ReturnButton*) self;
-            butt->onClickCb(butt);
+            CallbackTable::fire(butt, EVENT_CLICK);
         }, this);
     }
 
     // Set the onEnter callback function
     void onEnter(std::function<void(bobcat::Widget *)> cb) {
-        onEnterCb = cb;
+        CallbackTable::set(this, EVENT_ENTER, cb);
     }
 
     // Set the onLeave callback function
     void onLeave(std::function<void(bobcat::Widget *)> cb) {
-        onLeaveCb = cb;
+        CallbackTable::set(this, EVENT_LEAVE, cb);
     }
 
     // Set the alignment of the return button
@@ -119,6 +105,12 @@ public:
         Fl_Return_Button::take_focus();
     }
 
+    // Destructor to remove the callbacks and release the label of the return button
+    ~ReturnButton() {
+        CallbackTable::clear(this);
+        LabelPool::release(this);
+    }
+
     // Friend declaration for AppTest struct
     friend struct ::AppTest;
 };
@@ -0,0 +1,446 @@
+#ifndef BOBCAT_UI_SOFTWARE_CANVAS
+#define BOBCAT_UI_SOFTWARE_CANVAS
+
+#include "bobcat_ui.h"
+#include "command_list.h"
+#include "png_writer.h"
+#include <GL/gl.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace bobcat {
+
+// Result of comparing two frames pixel by pixel
+struct PixelDiff {
+    long differing; // Number of pixels where some channel differs by more than the tolerance
+    int maxDelta; // Largest difference seen in any channel
+};
+
+/**
+ * @class SoftwareCanvas_
+ * @brief A canvas that rasterizes CommandLists into memory instead of OpenGL.
+ *
+ * The canvas needs neither a display nor a GL context, which makes it usable
+ * for reference images in pixel-diff tests and for timing render code on plain
+ * machines. Subclasses implement render(CommandList &) the way a Canvas_
+ * subclass implements render(), using the same coordinate system (-1 to 1 on
+ * both axes, y pointing up).
+ *
+ * Primitives are anti-aliased with 4 sub-scanlines per pixel and analytic
+ * horizontal coverage. Coverage of consecutive primitives drawn with the same
+ * color is accumulated before it is blended, so shapes that are tessellated
+ * into several triangles show no seams along the shared edges.
+ */
+class SoftwareCanvas_ {
+    int width; // Width of the framebuffer in pixels
+    int height; // Height of the framebuffer in pixels
+    std::vector<unsigned int> pixels; // Framebuffer, RGBA bytes in memory order
+    std::vector<float> coverage; // Coverage accumulated for the current color
+    int dirtyX0, dirtyY0, dirtyX1, dirtyY1; // Bounds of the non-zero coverage
+    unsigned char background[4]; // Clear color
+    float current[4]; // Current drawing color
+    float lineW; // Current line width in pixels
+    float pointS; // Current point size in pixels
+    CommandList list; // List handed to render()
+    std::string caption; // Caption of the canvas
+
+    // Pack RGBA bytes into a framebuffer word
+    static unsigned int pack(const unsigned char rgba[4]) {
+        unsigned int v;
+        memcpy(&v, rgba, 4);
+        return v;
+    }
+
+    // Map canvas coordinates to pixel coordinates
+    float toPixelX(float x) const {
+        return (x + 1.0f) * 0.5f * width;
+    }
+
+    float toPixelY(float y) const {
+        return (1.0f - y) * 0.5f * height;
+    }
+
+    // Add weight times the covered fraction of [xl, xr) to a coverage row
+    void addSpan(float *row, float xl, float xr, float weight) {
+        int il = (int)xl;
+        int ir = (int)xr;
+        if (il == ir) {
+            row[il] += (xr - xl) * weight;
+            return;
+        }
+        row[il] += ((float)(il + 1) - xl) * weight;
+        int i = il + 1;
+#if defined(__AVX__)
+        __m256 w8 = _mm256_set1_ps(weight);
+        for (; i + 8 <= ir; i += 8) {
+            _mm256_storeu_ps(row + i, _mm256_add_ps(_mm256_loadu_ps(row + i), w8));
+        }
+#endif
+#if defined(__SSE2__)
+        __m128 w4 = _mm_set1_ps(weight);
+        for (; i + 4 <= ir; i += 4) {
+            _mm_storeu_ps(row + i, _mm_add_ps(_mm_loadu_ps(row + i), w4));
+        }
+#endif
+        for (; i < ir; i++) {
+            row[i] += weight;
+        }
+        if (ir < width) {
+            row[ir] += (xr - (float)ir) * weight;
+        }
+    }
+
+    // Accumulate the coverage of a triangle given in pixel coordinates
+    void triangle(float x0, float y0, float x1, float y1, float x2, float y2) {
+        float minY = std::min(y0, std::min(y1, y2));
+        float maxY = std::max(y0, std::max(y1, y2));
+        int rowStart = std::max(0, (int)floorf(minY));
+        int rowEnd = std::min(height, (int)ceilf(maxY));
+        if (rowStart >= rowEnd) return;
+
+        const float xs[3] = {x0, x1, x2};
+        const float ys[3] = {y0, y1, y2};
+        int spanMin = width;
+        int spanMax = -1;
+
+        for (int y = rowStart; y < rowEnd; y++) {
+            float *row = &coverage[(size_t)y * width];
+            for (int s = 0; s < 4; s++) {
+                float sy = (float)y + (s + 0.5f) * 0.25f;
+                float xl = 1e30f;
+                float xr = -1e30f;
+                for (int e = 0; e < 3; e++) {
+                    int f = (e + 1) % 3;
+                    if ((ys[e] <= sy && ys[f] > sy) || (ys[f] <= sy && ys[e] > sy)) {
+                        float x = xs[e] + (sy - ys[e]) * (xs[f] - xs[e]) / (ys[f] - ys[e]);
+                        xl = std::min(xl, x);
+                        xr = std::max(xr, x);
+                    }
+                }
+                xl = std::max(xl, 0.0f);
+                xr = std::min(xr, (float)width);
+                if (xl >= xr) continue;
+                addSpan(row, xl, xr, 0.25f);
+                spanMin = std::min(spanMin, (int)xl);
+                spanMax = std::max(spanMax, std::min(width - 1, (int)xr));
+            }
+        }
+
+        if (spanMax < spanMin) return;
+        dirtyX0 = std::min(dirtyX0, spanMin);
+        dirtyX1 = std::max(dirtyX1, spanMax + 1);
+        dirtyY0 = std::min(dirtyY0, rowStart);
+        dirtyY1 = std::max(dirtyY1, rowEnd);
+    }
+
+    // Accumulate a quad given as four corners in order
+    void quad(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3) {
+        triangle(x0, y0, x1, y1, x2, y2);
+        triangle(x0, y0, x2, y2, x3, y3);
+    }
+
+    // Accumulate a line of the current width between two pixel positions
+    void segment(float x0, float y0, float x1, float y1) {
+        float dx = x1 - x0;
+        float dy = y1 - y0;
+        float len = sqrtf(dx * dx + dy * dy);
+        if (len == 0.0f) return;
+        float nx = -dy / len * lineW * 0.5f;
+        float ny = dx / len * lineW * 0.5f;
+        quad(x0 + nx, y0 + ny, x1 + nx, y1 + ny, x1 - nx, y1 - ny, x0 - nx, y0 - ny);
+    }
+
+    // Accumulate a square point of the current size
+    void point(float x, float y) {
+        float r = pointS * 0.5f;
+        quad(x - r, y - r, x + r, y - r, x + r, y + r, x - r, y + r);
+    }
+
+    // Blend the accumulated coverage with the current color and reset it
+    void flush() {
+        if (dirtyX1 <= dirtyX0 || dirtyY1 <= dirtyY0) return;
+
+        unsigned char rgba[4];
+        for (int c = 0; c < 4; c++) {
+            float v = std::min(1.0f, std::max(0.0f, current[c]));
+            rgba[c] = (unsigned char)(v * 255.0f + 0.5f);
+        }
+        unsigned int solid = pack(rgba);
+        float alpha = current[3];
+        bool opaque = alpha >= 1.0f;
+
+        for (int y = dirtyY0; y < dirtyY1; y++) {
+            float *row = &coverage[(size_t)y * width];
+            unsigned int *dst = &pixels[(size_t)y * width];
+            int x = dirtyX0;
+            while (x < dirtyX1) {
+                float cov = row[x];
+                if (cov <= 0.0f) {
+                    x++;
+                    continue;
+                }
+                if (opaque && cov >= 0.999f) {
+                    // Fill the whole run of fully covered pixels at once
+                    int end = x;
+                    while (end < dirtyX1 && row[end] >= 0.999f) end++;
+                    int i = x;
+#if defined(__SSE2__)
+                    __m128i c4 = _mm_set1_epi32((int)solid);
+                    for (; i + 4 <= end; i += 4) {
+                        _mm_storeu_si128((__m128i *)(dst + i), c4);
+                    }
+#endif
+                    for (; i < end; i++) dst[i] = solid;
+                    memset(row + x, 0, sizeof(float) * (end - x));
+                    x = end;
+                    continue;
+                }
+
+                float a = alpha * std::min(cov, 1.0f);
+                unsigned char out[4];
+                memcpy(out, &dst[x], 4);
+                for (int c = 0; c < 3; c++) {
+                    out[c] = (unsigned char)(rgba[c] * a + out[c] * (1.0f - a) + 0.5f);
+                }
+                out[3] = (unsigned char)std::min(255.0f, out[3] + 255.0f * a * (1.0f - out[3] / 255.0f) + 0.5f);
+                memcpy(&dst[x], out, 4);
+                row[x] = 0.0f;
+                x++;
+            }
+        }
+
+        dirtyX0 = width;
+        dirtyY0 = height;
+        dirtyX1 = 0;
+        dirtyY1 = 0;
+    }
+
+    // Turn the vertices of a finished primitive into coverage
+    void assemble(GLenum mode, const std::vector<float> &v) {
+        size_t n = v.size() / 2;
+        switch (mode) {
+            case GL_POINTS:
+                for (size_t i = 0; i < n; i++) point(v[2 * i], v[2 * i + 1]);
+                break;
+            case GL_LINES:
+                for (size_t i = 0; i + 1 < n; i += 2) segment(v[2 * i], v[2 * i + 1], v[2 * i + 2], v[2 * i + 3]);
+                break;
+            case GL_LINE_STRIP:
+            case GL_LINE_LOOP:
+                for (size_t i = 0; i + 1 < n; i++) segment(v[2 * i], v[2 * i + 1], v[2 * i + 2], v[2 * i + 3]);
+                if (mode == GL_LINE_LOOP && n > 2) segment(v[2 * n - 2], v[2 * n - 1], v[0], v[1]);
+                break;
+            case GL_TRIANGLES:
+                for (size_t i = 0; i + 2 < n; i += 3) triangle(v[2 * i], v[2 * i + 1], v[2 * i + 2], v[2 * i + 3], v[2 * i + 4], v[2 * i + 5]);
+                break;
+            case GL_TRIANGLE_STRIP:
+                for (size_t i = 0; i + 2 < n; i++) triangle(v[2 * i], v[2 * i + 1], v[2 * i + 2], v[2 * i + 3], v[2 * i + 4], v[2 * i + 5]);
+                break;
+            case GL_TRIANGLE_FAN:
+            case GL_POLYGON:
+                for (size_t i = 1; i + 1 < n; i++) triangle(v[0], v[1], v[2 * i], v[2 * i + 1], v[2 * i + 2], v[2 * i + 3]);
+                break;
+            case GL_QUADS:
+                for (size_t i = 0; i + 3 < n; i += 4) quad(v[2 * i], v[2 * i + 1], v[2 * i + 2], v[2 * i + 3], v[2 * i + 4], v[2 * i + 5], v[2 * i + 6], v[2 * i + 7]);
+                break;
+            case GL_QUAD_STRIP:
+                for (size_t i = 0; i + 3 < n; i += 2) quad(v[2 * i], v[2 * i + 1], v[2 * i + 2], v[2 * i + 3], v[2 * i + 6], v[2 * i + 7], v[2 * i + 4], v[2 * i + 5]);
+                break;
+        }
+    }
+
+public:
+    // Constructor to initialize the canvas with width, height, and title
+    SoftwareCanvas_(int w, int h, std::string title = "") {
+        caption = title;
+        background[0] = background[1] = background[2] = 0;
+        background[3] = 255;
+        width = 0;
+        height = 0;
+        resize(w, h);
+    }
+
+    // Pure virtual function to render the canvas
+    virtual void render(CommandList &list) = 0;
+
+    // Clear the framebuffer, call render() and rasterize what it recorded
+    void draw() {
+        clear();
+        list.clear();
+        render(list);
+        execute(list);
+    }
+
+    // Change the size of the framebuffer, its content is cleared
+    void resize(int w, int h) {
+        width = std::max(1, w);
+        height = std::max(1, h);
+        pixels.assign((size_t)width * height, 0);
+        coverage.assign((size_t)width * height, 0.0f);
+        dirtyX0 = width;
+        dirtyY0 = height;
+        dirtyX1 = 0;
+        dirtyY1 = 0;
+        clear();
+    }
+
+    // Set the clear color
+    void clearColor(float r, float g, float b, float a = 1.0f) {
+        const float c[4] = {r, g, b, a};
+        for (int i = 0; i < 4; i++) {
+            background[i] = (unsigned char)(std::min(1.0f, std::max(0.0f, c[i])) * 255.0f + 0.5f);
+        }
+    }
+
+    // Fill the framebuffer with the clear color and reset the drawing state
+    void clear() {
+        std::fill(pixels.begin(), pixels.end(), pack(background));
+        current[0] = current[1] = current[2] = current[3] = 1.0f;
+        lineW = 1.0f;
+        pointS = 1.0f;
+    }
+
+    // Rasterize a command list on top of the current framebuffer
+    void execute(const CommandList &commands) {
+        const std::vector<DrawCommand> &cmds = commands.data();
+        std::vector<float> verts;
+        GLenum mode = GL_TRIANGLES;
+        bool inside = false;
+
+        for (size_t i = 0; i < cmds.size(); i++) {
+            const DrawCommand &cmd = cmds[i];
+            switch (cmd.op) {
+                case DRAW_COLOR:
+                    if (cmd.a != current[0] || cmd.b != current[1] || cmd.c != current[2] || cmd.d != current[3]) {
+                        // Triangles finished so far belong to the old color
+                        if (inside && mode == GL_TRIANGLES) {
+                            size_t done = verts.size() / 6 * 6;
+                            assemble(mode, std::vector<float>(verts.begin(), verts.begin() + done));
+                            verts.erase(verts.begin(), verts.begin() + done);
+                        }
+                        flush();
+                        current[0] = cmd.a;
+                        current[1] = cmd.b;
+                        current[2] = cmd.c;
+                        current[3] = cmd.d;
+                    }
+                    break;
+                case DRAW_LINE_WIDTH:
+                    lineW = cmd.a;
+                    break;
+                case DRAW_POINT_SIZE:
+                    pointS = cmd.a;
+                    break;
+                case DRAW_BEGIN:
+                    mode = cmd.mode;
+                    verts.clear();
+                    inside = true;
+                    break;
+                case DRAW_VERTEX:
+                    verts.push_back(toPixelX(cmd.a));
+                    verts.push_back(toPixelY(cmd.b));
+                    break;
+                case DRAW_END:
+                    assemble(mode, verts);
+                    verts.clear();
+                    inside = false;
+                    break;
+            }
+        }
+        flush();
+    }
+
+    // Rasterize and recycle the lists queued in a RenderQueue
+    void submit(RenderQueue &queue) {
+        std::vector<CommandList *> lists = queue.take();
+        for (size_t i = 0; i < lists.size(); i++) {
+            execute(*lists[i]);
+        }
+        queue.recycle(lists);
+    }
+
+    // Get the width of the framebuffer
+    int w() const {
+        return width;
+    }
+
+    // Get the height of the framebuffer
+    int h() const {
+        return height;
+    }
+
+    // Get the framebuffer as tightly packed RGBA rows, top row first
+    const unsigned char *data() const {
+        return (const unsigned char *)pixels.data();
+    }
+
+    // Get the RGBA value of a pixel, packed as 0xRRGGBBAA
+    unsigned int pixel(int x, int y) const {
+        const unsigned char *p = data() + ((size_t)y * width + x) * 4;
+        return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+    }
+
+    // Write the framebuffer to a PNG file
+    bool savePNG(std::string filename) const {
+        return PNGWriter::write(filename, data(), width, height, 4);
+    }
+
+    // Compare the framebuffer with RGBA pixels of the same size
+    PixelDiff compare(const unsigned char *other, int tolerance = 0) const {
+        PixelDiff result;
+        result.differing = 0;
+        result.maxDelta = 0;
+        const unsigned char *mine = data();
+        size_t count = (size_t)width * height;
+        for (size_t i = 0; i < count; i++) {
+            int worst = 0;
+            for (int c = 0; c < 4; c++) {
+                worst = std::max(worst, std::abs((int)mine[4 * i + c] - (int)other[4 * i + c]));
+            }
+            if (worst > tolerance) result.differing++;
+            result.maxDelta = std::max(result.maxDelta, worst);
+        }
+        return result;
+    }
+
+    // Compare the framebuffer with another canvas of the same size
+    PixelDiff compare(const SoftwareCanvas_ &other, int tolerance = 0) const {
+        if (other.width != width || other.height != height) {
+            PixelDiff result;
+            result.differing = (long)width * height;
+            result.maxDelta = 255;
+            return result;
+        }
+        return compare(other.data(), tolerance);
+    }
+
+    // Get the label of the canvas
+    std::string label() const {
+        return caption;
+    }
+
+    // Set the label of the canvas
+    void label(std::string s) {
+        caption = s;
+    }
+
+    virtual ~SoftwareCanvas_() {}
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
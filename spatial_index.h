@@ -0,0 +1,237 @@
+#ifndef BOBCAT_UI_SPATIAL_INDEX
+#define BOBCAT_UI_SPATIAL_INDEX
+
+#include "bobcat_ui.h"
+#include <FL/Enumerations.H>
+#include <FL/Fl.H>
+#include <FL/Fl_Group.H>
+#include <FL/Fl_Widget.H>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace bobcat {
+
+/**
+ * @class SpatialIndex
+ * @brief A grid of buckets that finds the children of a group under the pointer.
+ *
+ * Fl_Group finds the child under the pointer by testing every child. The index
+ * puts each child in the grid cells its rect covers, so FL_PUSH, FL_MOVE and
+ * FL_ENTER only test the few children sharing the pointer's cell. Children
+ * moved through TextBox::moveTo, by a Layout or by a VirtualList are
+ * reindexed one at a time; code that moves children some other way, such as
+ * a plain resize() or position(), must call moved(). Adding or
+ * removing children, or resizing a group without a layout, rebuilds the index
+ * on the next event. Children covering many cells are kept in a list that is
+ * always tested.
+ */
+class SpatialIndex {
+    // Rect and stacking order of an indexed child
+    struct Entry {
+        int x, y, w, h;
+        int z; // Index of the child in the group, higher is on top
+    };
+
+    Fl_Group *owner; // Group whose children are indexed
+    int cellSize; // Width and height of a grid cell
+    std::unordered_map<uint64_t, std::vector<Fl_Widget *>> cells; // Children by grid cell
+    std::vector<Fl_Widget *> large; // Children covering too many cells to bucket
+    std::unordered_map<const Fl_Widget *, Entry> entries; // Indexed children
+    int indexed; // Number of children when the index was built
+    bool stale; // The index must be rebuilt before use
+
+    // Children covering more cells than this go in the large list
+    static const int maxCells = 64;
+
+    // Get the table of indexes by group
+    static std::unordered_map<const Fl_Widget *, SpatialIndex *> &registry() {
+        static std::unordered_map<const Fl_Widget *, SpatialIndex *> table;
+        return table;
+    }
+
+    // Get the cell coordinate of a pixel coordinate, rounding down for negative ones
+    int cell(int v) const {
+        return v >= 0 ? v / cellSize : -((-v + cellSize - 1) / cellSize);
+    }
+
+    // Get the key of a grid cell
+    static uint64_t key(int cx, int cy) {
+        return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+    }
+
+    // Check if a rect covers few enough cells to bucket
+    bool bucketed(const Entry &e) const {
+        if (e.w <= 0 || e.h <= 0) return false;
+        long long n = (long long)(cell(e.x + e.w - 1) - cell(e.x) + 1) * (cell(e.y + e.h - 1) - cell(e.y) + 1);
+        return n <= maxCells;
+    }
+
+    // Add a child with its current rect
+    void insert(Fl_Widget *widget, int z) {
+        Entry e;
+        e.x = widget->x();
+        e.y = widget->y();
+        e.w = widget->w();
+        e.h = widget->h();
+        e.z = z;
+        entries[widget] = e;
+        if (!bucketed(e)) {
+            large.push_back(widget);
+            return;
+        }
+        for (int cy = cell(e.y); cy <= cell(e.y + e.h - 1); cy++) {
+            for (int cx = cell(e.x); cx <= cell(e.x + e.w - 1); cx++) {
+                cells[key(cx, cy)].push_back(widget);
+            }
+        }
+    }
+
+    // Take a child out of the cells it was indexed in
+    void erase(Fl_Widget *widget, const Entry &e) {
+        if (!bucketed(e)) {
+            large.erase(std::remove(large.begin(), large.end(), widget), large.end());
+            return;
+        }
+        for (int cy = cell(e.y); cy <= cell(e.y + e.h - 1); cy++) {
+            for (int cx = cell(e.x); cx <= cell(e.x + e.w - 1); cx++) {
+                std::unordered_map<uint64_t, std::vector<Fl_Widget *>>::iterator it = cells.find(key(cx, cy));
+                if (it == cells.end()) continue;
+                std::vector<Fl_Widget *> &bucket = it->second;
+                bucket.erase(std::remove(bucket.begin(), bucket.end(), widget), bucket.end());
+                if (bucket.empty()) cells.erase(it);
+            }
+        }
+    }
+
+    // Index every child again
+    void rebuild() {
+        cells.clear();
+        large.clear();
+        entries.clear();
+        for (int i = 0; i < owner->children(); i++) insert(owner->child(i), i);
+        indexed = owner->children();
+        stale = false;
+    }
+
+    // Get the children that may contain a point, topmost first
+    // Entries are checked against the group's child array without touching the
+    // widgets, so a child that was removed or deleted forces a rebuild instead
+    std::vector<Fl_Widget *> candidates(int px, int py) {
+        for (int attempt = 0; attempt < 2; attempt++) {
+            if (stale || indexed != owner->children()) rebuild();
+            std::vector<Fl_Widget *> found(large);
+            std::unordered_map<uint64_t, std::vector<Fl_Widget *>>::const_iterator it = cells.find(key(cell(px), cell(py)));
+            if (it != cells.end()) found.insert(found.end(), it->second.begin(), it->second.end());
+
+            bool valid = true;
+            for (size_t i = 0; i < found.size() && valid; i++) {
+                const Entry &e = entries[found[i]];
+                valid = e.z < owner->children() && owner->child(e.z) == found[i];
+            }
+            if (!valid) {
+                stale = true;
+                continue;
+            }
+            std::sort(found.begin(), found.end(), [this](Fl_Widget *a, Fl_Widget *b) { return entries[a].z > entries[b].z; });
+            return found;
+        }
+        return std::vector<Fl_Widget *>();
+    }
+
+public:
+    // Constructor to index the children of owner in cells of cellSize pixels
+    SpatialIndex(Fl_Group *owner, int cellSize = 64) {
+        this->owner = owner;
+        this->cellSize = std::max(1, cellSize);
+        indexed = 0;
+        stale = true;
+        registry()[owner] = this;
+    }
+
+    // Get the index of a group, or null
+    static SpatialIndex *of(const Fl_Widget *group) {
+        std::unordered_map<const Fl_Widget *, SpatialIndex *>::iterator it = registry().find(group);
+        return it == registry().end() ? nullptr : it->second;
+    }
+
+    // Reindex a widget that moved or changed size, if its group has an index
+    static void moved(Fl_Widget *widget) {
+        SpatialIndex *index = widget->parent() ? of(widget->parent()) : nullptr;
+        if (index) index->update(widget);
+    }
+
+    // Reindex one child if its rect changed
+    void update(Fl_Widget *widget) {
+        if (stale) return;
+        std::unordered_map<const Fl_Widget *, Entry>::iterator it = entries.find(widget);
+        if (it == entries.end()) {
+            stale = true;
+            return;
+        }
+        Entry e = it->second;
+        if (e.x == widget->x() && e.y == widget->y() && e.w == widget->w() && e.h == widget->h()) return;
+        erase(widget, e);
+        insert(widget, e.z);
+    }
+
+    // Rebuild the index on the next event
+    void invalidate() {
+        stale = true;
+    }
+
+    // Send a pointer event to the child under the pointer the way Fl_Group does,
+    // returning what Fl_Group::handle would, or -1 if the event should go through it instead
+    int route(int event) {
+        if (event != FL_PUSH && event != FL_MOVE && event != FL_ENTER) return -1;
+        std::vector<Fl_Widget *> found = candidates(Fl::event_x(), Fl::event_y());
+        for (size_t i = 0; i < found.size(); i++) {
+            // Subwindows use their own coordinates, leave them to FLTK
+            if (found[i]->as_window()) return -1;
+        }
+
+        for (size_t i = 0; i < found.size(); i++) {
+            Fl_Widget *o = found[i];
+            if (event == FL_PUSH) {
+                if (!o->takesevents() || !Fl::event_inside(o)) continue;
+                Fl_Widget_Tracker wp(o);
+                if (o->handle(FL_PUSH)) {
+                    if (Fl::pushed() && wp.exists() && !o->contains(Fl::pushed())) Fl::pushed(o);
+                    return 1;
+                }
+                if (wp.deleted()) {
+                    stale = true;
+                    return 1;
+                }
+                continue;
+            }
+            if (!o->visible() || !Fl::event_inside(o)) continue;
+            if (o->contains(Fl::belowmouse())) return o->handle(FL_MOVE);
+            Fl::belowmouse(o);
+            if (o->handle(FL_ENTER)) return 1;
+        }
+
+        // Fl_Group ends up in Fl_Widget::handle when no child takes a push
+        if (event == FL_PUSH) return owner->Fl_Widget::handle(event);
+        Fl::belowmouse(owner);
+        return 1;
+    }
+
+    // Get the number of occupied grid cells
+    size_t cellCount() const {
+        return cells.size();
+    }
+
+    // Destructor to unregister the index
+    ~SpatialIndex() {
+        registry().erase(owner);
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -0,0 +1,357 @@
+#ifndef BOBCAT_UI_SPRITE
+#define BOBCAT_UI_SPRITE
+
+#include "bobcat_ui.h"
+#include "asset_bundle.h"
+#include "pixel_buffer.h"
+#include <FL/Fl_PNG_Image.H>
+#include <GL/gl.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bobcat {
+
+// Location of a packed image inside a TextureAtlas
+struct AtlasRegion {
+    int page; // Index of the atlas page
+    int w, h; // Size of the image in pixels
+    float u0, v0, u1, v1; // Texture coordinates of the top left and bottom right corners
+};
+
+/**
+ * @class TextureAtlas
+ * @brief Packs many small images into a few large textures.
+ *
+ * Images are packed on shelves when they are added, so that drawing them later
+ * needs one texture bind per page instead of one per image. Pages are uploaded
+ * to OpenGL lazily by upload(), which must run with the canvas context current,
+ * for example from render().
+ */
+class TextureAtlas {
+    struct Page {
+        PixelBuffer pixels; // Page content
+        GLuint texture; // GL texture, 0 until uploaded
+        int shelfX; // Next free column on the current shelf
+        int shelfY; // Top of the current shelf
+        int shelfH; // Height of the tallest image on the current shelf
+        bool dirty; // Whether the texture is out of date
+    };
+
+    int pageSize; // Width and height of every page
+    int padding; // Empty pixels kept around every image to stop filtering bleed
+    std::vector<Page> pages; // Atlas pages
+    std::vector<AtlasRegion> regions; // Packed images, indexed by sprite id
+
+    // Find room for a w x h rectangle, returns false if no page can take it
+    bool place(int w, int h, int &page, int &px, int &py) {
+        int pw = w + 2 * padding;
+        int ph = h + 2 * padding;
+        if (pw > pageSize || ph > pageSize) return false;
+
+        for (size_t i = 0; i < pages.size(); i++) {
+            Page &p = pages[i];
+            if (p.shelfX + pw > pageSize) {
+                // Start a new shelf below the current one, unless the image does not fit there
+                // either; the current shelf then stays open for narrower images
+                if (p.shelfY + p.shelfH + ph > pageSize) continue;
+                p.shelfY += p.shelfH;
+                p.shelfX = 0;
+                p.shelfH = 0;
+            }
+            if (p.shelfY + ph <= pageSize) {
+                page = (int)i;
+                px = p.shelfX + padding;
+                py = p.shelfY + padding;
+                p.shelfX += pw;
+                p.shelfH = std::max(p.shelfH, ph);
+                return true;
+            }
+        }
+
+        Page fresh;
+        fresh.pixels = PixelBuffer(pageSize, pageSize);
+        fresh.texture = 0;
+        fresh.shelfX = pw;
+        fresh.shelfY = 0;
+        fresh.shelfH = ph;
+        fresh.dirty = true;
+        pages.push_back(fresh);
+        page = (int)pages.size() - 1;
+        px = padding;
+        py = padding;
+        return true;
+    }
+
+public:
+    // Constructor to set the page size and padding
+    TextureAtlas(int size = 2048, int pad = 1) {
+        pageSize = size;
+        padding = pad;
+    }
+
+    // Pack RGBA pixels, returns the sprite id or -1 if the image does not fit on a page
+    int add(const PixelBuffer &img) {
+        if (img.empty()) return -1;
+        int page, px, py;
+        if (!place(img.w, img.h, page, px, py)) return -1;
+
+        Page &p = pages[page];
+        for (int y = 0; y < img.h; y++) {
+            memcpy(p.pixels.row(py + y) + (size_t)px * 4, img.row(y), (size_t)img.w * 4);
+        }
+        p.dirty = true;
+
+        AtlasRegion r;
+        r.page = page;
+        r.w = img.w;
+        r.h = img.h;
+        r.u0 = (float)px / pageSize;
+        r.v0 = (float)py / pageSize;
+        r.u1 = (float)(px + img.w) / pageSize;
+        r.v1 = (float)(py + img.h) / pageSize;
+        regions.push_back(r);
+        return (int)regions.size() - 1;
+    }
+
+    // Load and pack a PNG file, returns the sprite id or -1 if it could not be loaded
+    int add(std::string filename) {
+        std::unique_ptr<Fl_PNG_Image> png(AssetBundle::loadPNG(filename));
+        return add(PixelBuffer::fromImage(png.get()));
+    }
+
+    // Load and pack several PNG files, tallest first for tighter shelves, ids follow the input order
+    std::vector<int> add(const std::vector<std::string> &filenames) {
+        std::vector<PixelBuffer> images(filenames.size());
+        std::vector<size_t> order(filenames.size());
+        for (size_t i = 0; i < filenames.size(); i++) {
+            std::unique_ptr<Fl_PNG_Image> png(AssetBundle::loadPNG(filenames[i]));
+            images[i] = PixelBuffer::fromImage(png.get());
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return images[a].h > images[b].h;
+        });
+
+        std::vector<int> ids(filenames.size(), -1);
+        for (size_t i = 0; i < order.size(); i++) {
+            ids[order[i]] = add(images[order[i]]);
+        }
+        return ids;
+    }
+
+    // Get the region of a sprite id
+    const AtlasRegion &region(int id) const {
+        return regions[id];
+    }
+
+    // Get the number of packed images
+    int count() const {
+        return (int)regions.size();
+    }
+
+    // Get the number of pages
+    int pageCount() const {
+        return (int)pages.size();
+    }
+
+    // Send pages that changed since the last call to OpenGL
+    void upload() {
+        for (size_t i = 0; i < pages.size(); i++) {
+            Page &p = pages[i];
+            if (!p.dirty) continue;
+            if (p.texture == 0) glGenTextures(1, &p.texture);
+            glBindTexture(GL_TEXTURE_2D, p.texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, pageSize, pageSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, p.pixels.rgba.data());
+            p.dirty = false;
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // Forget the uploaded textures, call after the GL context was recreated
+    void invalidate() {
+        for (size_t i = 0; i < pages.size(); i++) {
+            pages[i].texture = 0;
+            pages[i].dirty = true;
+        }
+    }
+
+    // Release the textures, must be called with the context current
+    void release() {
+        for (size_t i = 0; i < pages.size(); i++) {
+            if (pages[i].texture) glDeleteTextures(1, &pages[i].texture);
+        }
+        invalidate();
+    }
+
+    // Get the texture of a page, 0 until uploaded
+    GLuint texture(int page) const {
+        return pages[page].texture;
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+// A sprite instance to be drawn by a SpriteBatch, positions and sizes are in canvas coordinates
+struct Sprite {
+    int id; // Sprite id returned by TextureAtlas::add
+    float x, y; // Center of the sprite
+    float w, h; // Size before scaling
+    float rotation; // Rotation in radians, counterclockwise
+    float scaleX, scaleY; // Scale factors
+    float r, g, b, a; // Tint multiplied with the texture
+    float z; // Sprites with a lower z are drawn first
+
+    // Constructor to create an untinted, unrotated sprite
+    Sprite(int id = 0, float x = 0, float y = 0, float w = 0.1f, float h = 0.1f, float z = 0) {
+        this->id = id;
+        this->x = x;
+        this->y = y;
+        this->w = w;
+        this->h = h;
+        this->z = z;
+        rotation = 0;
+        scaleX = 1;
+        scaleY = 1;
+        r = g = b = a = 1;
+    }
+};
+
+/**
+ * @class SpriteBatch
+ * @brief Draws many sprites from a TextureAtlas with one draw call per page.
+ *
+ * Sprites are collected with draw() during render() and sent to OpenGL by
+ * flush(), ordered by z. Sprites with equal z keep the order they were added
+ * in, and consecutive sprites that live on the same atlas page share a draw call.
+ */
+class SpriteBatch {
+    // Interleaved vertex layout used with the GL 1.1 vertex arrays
+    struct Vertex {
+        float x, y;
+        float u, v;
+        unsigned char r, g, b, a;
+    };
+
+    TextureAtlas *atlas; // Atlas the sprites come from
+    std::vector<Sprite> sprites; // Sprites queued for the next flush
+    std::vector<size_t> order; // Draw order of the queued sprites
+    std::vector<Vertex> vertices; // Vertex storage, kept between frames
+    int drawCalls; // Draw calls issued by the last flush
+
+    // Convert a tint component to a byte
+    static unsigned char toByte(float v) {
+        return (unsigned char)(std::min(1.0f, std::max(0.0f, v)) * 255.0f + 0.5f);
+    }
+
+    // Append the four corners of a sprite
+    void emit(const Sprite &s) {
+        const AtlasRegion &reg = atlas->region(s.id);
+        float hw = s.w * s.scaleX * 0.5f;
+        float hh = s.h * s.scaleY * 0.5f;
+        float c = cosf(s.rotation);
+        float sn = sinf(s.rotation);
+        const float cx[4] = {-hw, hw, hw, -hw};
+        const float cy[4] = {hh, hh, -hh, -hh};
+        const float cu[4] = {reg.u0, reg.u1, reg.u1, reg.u0};
+        const float cv[4] = {reg.v0, reg.v0, reg.v1, reg.v1};
+        unsigned char r = toByte(s.r), g = toByte(s.g), b = toByte(s.b), a = toByte(s.a);
+        for (int i = 0; i < 4; i++) {
+            Vertex v;
+            v.x = s.x + cx[i] * c - cy[i] * sn;
+            v.y = s.y + cx[i] * sn + cy[i] * c;
+            v.u = cu[i];
+            v.v = cv[i];
+            v.r = r;
+            v.g = g;
+            v.b = b;
+            v.a = a;
+            vertices.push_back(v);
+        }
+    }
+
+public:
+    // Constructor to bind the batch to an atlas
+    SpriteBatch(TextureAtlas *atlas) {
+        this->atlas = atlas;
+        drawCalls = 0;
+    }
+
+    // Queue a sprite for the next flush
+    void draw(const Sprite &sprite) {
+        if (sprite.id < 0 || sprite.id >= atlas->count()) return;
+        sprites.push_back(sprite);
+    }
+
+    // Get the number of queued sprites
+    int size() const {
+        return (int)sprites.size();
+    }
+
+    // Get the number of draw calls issued by the last flush
+    int lastDrawCalls() const {
+        return drawCalls;
+    }
+
+    // Draw and clear the queued sprites, must be called from render()
+    void flush() {
+        drawCalls = 0;
+        if (sprites.empty()) return;
+        atlas->upload();
+
+        order.resize(sprites.size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return sprites[a].z < sprites[b].z;
+        });
+
+        vertices.clear();
+        for (size_t i = 0; i < order.size(); i++) {
+            emit(sprites[order[i]]);
+        }
+
+        glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT);
+        glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+        glEnable(GL_TEXTURE_2D);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].x);
+        glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].u);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &vertices[0].r);
+
+        size_t start = 0;
+        while (start < order.size()) {
+            int page = atlas->region(sprites[order[start]].id).page;
+            size_t end = start + 1;
+            while (end < order.size() && atlas->region(sprites[order[end]].id).page == page) end++;
+            glBindTexture(GL_TEXTURE_2D, atlas->texture(page));
+            glDrawArrays(GL_QUADS, (GLint)(start * 4), (GLsizei)((end - start) * 4));
+            drawCalls++;
+            start = end;
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glPopClientAttrib();
+        glPopAttrib();
+        sprites.clear();
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef BOBCAT_UI_TEXT_LAYOUT
+#define BOBCAT_UI_TEXT_LAYOUT
+
+#include "bobcat_ui.h"
+#include <FL/Enumerations.H>
+#include <FL/Fl.H>
+#include <FL/fl_draw.H>
+#include <functional>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace bobcat {
+
+// A run of text drawn on one line, as a range of the laid out string
+struct TextRun {
+    size_t start; // Offset of the first character
+    size_t length; // Number of bytes
+    int width; // Measured width in pixels
+};
+
+// Measured lines of a string in one font, size and width
+struct TextLayout {
+    std::vector<TextRun> lines; // One run per line
+    int width; // Width of the widest line
+    int height; // Height of all lines
+    int lineHeight; // Distance between baselines
+    int descent; // Distance from the baseline to the bottom of a line
+};
+
+/**
+ * @class TextLayoutCache
+ * @brief Measured and wrapped text, shared by every widget that draws labels.
+ *
+ * Laying out a label means measuring it with FLTK and, for wrapped labels,
+ * measuring every candidate line. The cache keeps the result per string,
+ * font, size and wrap width, so a label is only measured when one of those
+ * changes. Lines are kept as runs of the original string with their widths,
+ * which is as fine as FLTK 1.3 can draw. The least recently used layouts are
+ * dropped past the capacity. Font metrics are not watched: call invalidate(),
+ * or set fonts with setFont(), after changing fonts or the theme.
+ */
+class TextLayoutCache {
+    // Key of a layout, the text views the string of its entry
+    struct Key {
+        std::string_view text;
+        Fl_Font font;
+        Fl_Fontsize size;
+        int width;
+
+        bool operator==(const Key &other) const {
+            return text == other.text && font == other.font && size == other.size && width == other.width;
+        }
+    };
+
+    // Hash of a key
+    struct KeyHash {
+        size_t operator()(const Key &k) const {
+            size_t h = std::hash<std::string_view>()(k.text);
+            h ^= (size_t)k.font * 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            h ^= (size_t)k.size * 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            h ^= (size_t)k.width * 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    // A cached layout with its own copy of the text
+    struct Entry {
+        std::string text;
+        Key key;
+        TextLayout layout;
+    };
+
+    std::list<Entry> entries; // Most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index; // Entries by key
+    size_t capacity; // Most layouts kept
+    unsigned long gen; // Bumped by invalidate()
+    size_t hitCount; // Lookups answered from the cache
+    size_t missCount; // Lookups that measured text
+
+    TextLayoutCache() {
+        capacity = 2048;
+        gen = 0;
+        hitCount = 0;
+        missCount = 0;
+    }
+
+    // Measure a string, breaking lines at newlines and, if width is positive, between words
+    static void measure(std::string_view text, Fl_Font font, Fl_Fontsize size, int width, TextLayout &layout) {
+        fl_font(font, size);
+        layout.lines.clear();
+        layout.width = 0;
+        layout.lineHeight = fl_height();
+        layout.descent = fl_descent();
+
+        size_t start = 0;
+        while (start <= text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string_view::npos) end = text.size();
+
+            // Break the paragraph greedily at spaces, a word wider than the line gets a line of its own
+            size_t lineStart = start;
+            while (true) {
+                size_t lineEnd = end;
+                if (width > 0 && fl_width(text.data() + lineStart, (int)(end - lineStart)) > width) {
+                    size_t fit = lineStart;
+                    for (size_t space = text.find(' ', lineStart); space != std::string_view::npos && space < end; space = text.find(' ', space + 1)) {
+                        if (fl_width(text.data() + lineStart, (int)(space - lineStart)) > width) break;
+                        fit = space;
+                    }
+                    if (fit == lineStart) {
+                        fit = text.find(' ', lineStart);
+                        if (fit == std::string_view::npos || fit > end) fit = end;
+                    }
+                    lineEnd = fit;
+                }
+
+                TextRun run;
+                run.start = lineStart;
+                run.length = lineEnd - lineStart;
+                // Spaces where a line was wrapped take no room
+                while (lineEnd < end && run.length > 0 && text[lineStart + run.length - 1] == ' ') run.length--;
+                run.width = (int)(fl_width(text.data() + lineStart, (int)run.length) + 0.5);
+                layout.lines.push_back(run);
+                if (run.width > layout.width) layout.width = run.width;
+
+                if (lineEnd >= end) break;
+                lineStart = lineEnd + 1;
+            }
+            start = end + 1;
+        }
+        layout.height = (int)layout.lines.size() * layout.lineHeight;
+    }
+
+public:
+    // Get the cache shared by all bobcat widgets
+    static TextLayoutCache &shared() {
+        static TextLayoutCache cache;
+        return cache;
+    }
+
+    // Get the layout of a string, width 0 keeps each line whole
+    const TextLayout &get(std::string_view text, Fl_Font font, Fl_Fontsize size, int width = 0) {
+        Key key = {text, font, size, width > 0 ? width : 0};
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash>::iterator it = index.find(key);
+        if (it != index.end()) {
+            hitCount++;
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->layout;
+        }
+
+        missCount++;
+        entries.push_front(Entry());
+        Entry &e = entries.front();
+        e.text.assign(text.data(), text.size());
+        e.key = key;
+        e.key.text = std::string_view(e.text);
+        measure(e.key.text, font, size, key.width, e.layout);
+        index[e.key] = entries.begin();
+
+        while (entries.size() > capacity) {
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+        return e.layout;
+    }
+
+    // Draw a string laid out inside a box, aligned like an FLTK label inside a widget
+    // The current color is used, FL_ALIGN_WRAP breaks lines at the box width and FL_ALIGN_CLIP clips to the box
+    void draw(std::string_view text, Fl_Font font, Fl_Fontsize size, int x, int y, int w, int h, Fl_Align align) {
+        if (text.empty()) return;
+        const TextLayout &layout = get(text, font, size, (align & FL_ALIGN_WRAP) ? w : 0);
+        fl_font(font, size);
+
+        int top = y + (h - layout.height) / 2;
+        if (align & FL_ALIGN_TOP) top = y;
+        else if (align & FL_ALIGN_BOTTOM) top = y + h - layout.height;
+
+        if (align & FL_ALIGN_CLIP) fl_push_clip(x, y, w, h);
+        for (size_t i = 0; i < layout.lines.size(); i++) {
+            const TextRun &run = layout.lines[i];
+            int left = x + (w - run.width) / 2;
+            if (align & FL_ALIGN_LEFT) left = x;
+            else if (align & FL_ALIGN_RIGHT) left = x + w - run.width;
+            int baseline = top + (int)(i + 1) * layout.lineHeight - layout.descent;
+            fl_draw(text.data() + run.start, (int)run.length, left, baseline);
+        }
+        if (align & FL_ALIGN_CLIP) fl_pop_clip();
+    }
+
+    // Forget every layout, after fonts or the theme changed
+    void invalidate() {
+        index.clear();
+        entries.clear();
+        gen++;
+    }
+
+    // Get a number that changes whenever the layouts are invalidated
+    unsigned long generation() const {
+        return gen;
+    }
+
+    // Replace a font and forget the layouts measured with the old one
+    static void setFont(Fl_Font font, const char *name) {
+        Fl::set_font(font, name);
+        shared().invalidate();
+    }
+
+    // Get the number of cached layouts
+    size_t count() const {
+        return entries.size();
+    }
+
+    // Get the number of lookups answered from the cache
+    size_t hits() const {
+        return hitCount;
+    }
+
+    // Get the number of lookups that measured text
+    size_t misses() const {
+        return missCount;
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
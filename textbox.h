@@ -2,38 +2,60 @@
 #define BOBCAT_UI_TEXTBOX
 
 #include "bobcat_ui.h"
+#include "callbacks.h"
+#include "label_pool.h"
+#include "render_cache.h"
+#include "spatial_index.h"
+#include "text_layout.h"
 #include <FL/Enumerations.H>
 #include <FL/Fl.H>
 #include <FL/Fl_Box.H>
 #include <FL/Fl_Widget.H>
+#include <FL/Fl_Window.H>
+#include <FL/fl_draw.H>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <functional>
 
 namespace bobcat {
 
 // TextBox class inheriting from Fl_Box
 class TextBox: public Fl_Box {
-    std::string caption; // Caption of the text box
+    std::unique_ptr<RenderCache> renderCache; // Offscreen copy of the text box, see cache()
 
-    // Callback functions for various events
-    std::function<void(bobcat::Widget *)> onClickCb;
-    std::function<void(bobcat::Widget *)> onEnterCb;
-    std::function<void(bobcat::Widget *)> onLeaveCb;
+    // Paint the text box again on its next draw
+    void invalidateCache() {
+        if (renderCache) renderCache->invalidate();
+    }
 
-    // Initialize the callback functions to nullptr
-    void init() {
-        onClickCb = nullptr;
-        onEnterCb = nullptr;
-        onLeaveCb = nullptr;
+    // Draw the box and the label, measuring the label through the shared layout cache
+    // Labels with an image, symbols or a special label type are left to Fl_Box
+    void paint() {
+        std::string_view text = label();
+        if (image() || labeltype() != FL_NORMAL_LABEL || text.find('@') != std::string_view::npos) {
+            Fl_Box::draw();
+            return;
+        }
+        draw_box();
+        int X = x() + Fl::box_dx(box()), W = w() - Fl::box_dw(box());
+        int Y = y() + Fl::box_dy(box()), H = h() - Fl::box_dh(box());
+        // Same inset as Fl_Widget::draw_label() for labels against a side
+        if (W > 11 && (Fl_Box::align() & (FL_ALIGN_LEFT | FL_ALIGN_RIGHT))) {
+            X += 3;
+            W -= 6;
+        }
+        fl_color(active_r() ? Fl_Box::labelcolor() : fl_inactive(Fl_Box::labelcolor()));
+        TextLayoutCache::shared().draw(text, Fl_Box::labelfont(), Fl_Box::labelsize(), X, Y, W, H, Fl_Box::align());
     }
 
     // Handle events for the text box
     int handle(int event) {
         if (event == FL_ENTER) {
-            if (onEnterCb) onEnterCb(this);
+            CallbackTable::fire(this, EVENT_ENTER);
         }
         if (event == FL_LEAVE) {
-            if (onLeaveCb) onLeaveCb(this);
+            CallbackTable::fire(this, EVENT_LEAVE);
         }
 
         if (event == FL_PUSH) {
@@ -44,7 +66,7 @@ class TextBox: public Fl_Box {
         if (event == FL_RELEASE) {
             if (Fl::event_inside(this)) {
                 if (Fl::focus() == this) {
-                    if (onClickCb) onClickCb(this);
+                    CallbackTable::fire(this, EVENT_CLICK);
                 }
             }
         }
@@ -55,41 +77,39 @@ class TextBox: public Fl_Box {
 public:
     // Constructor to initialize the text box with position, size, and caption
     TextBox(int x, int y, int w, int h, std::string caption = ""): Fl_Box(x, y, w, h, caption.c_str()) {
-        init();
         Fl_Box::align(FL_ALIGN_INSIDE | FL_ALIGN_LEFT);
-        this->caption = caption;
-        Fl_Box::copy_label(caption.c_str());
+        LabelPool::assign(this, caption);
     }
 
     // Get the label of the text box
-    std::string label() const {
-        return caption;
+    std::string_view label() const {
+        return LabelPool::view(this);
     }
 
     // Set the label of the text box
-    void label(std::string s) {
-        Fl_Box::copy_label(s.c_str());
-        caption = s;
+    void label(std::string_view s) {
+        if (LabelPool::assign(this, s)) invalidateCache();
     }
 
     // Set the onClick callback function
     void onClick(std::function<void(bobcat::Widget *)> cb) {
-        onClickCb = cb;
+        CallbackTable::set(this, EVENT_CLICK, cb);
     }
 
     // Set the onEnter callback function
     void onEnter(std::function<void(bobcat::Widget *)> cb) {
-        onEnterCb = cb;
+        CallbackTable::set(this, EVENT_ENTER, cb);
     }
 
     // Set the onLeave callback function
     void onLeave(std::function<void(bobcat::Widget *)> cb) {
-        onLeaveCb = cb;
+        CallbackTable::set(this, EVENT_LEAVE, cb);
     }
 
     // Set the alignment of the text box
     void align(Fl_Align alignment) {
         Fl_Box::align(FL_ALIGN_INSIDE | alignment);
+        invalidateCache();
         redraw_label();
     }
 
@@ -101,6 +121,7 @@ public:
     // Set the label size of the text box
     void labelsize(Fl_Fontsize pix) {
         Fl_Box::labelsize(pix);
+        invalidateCache();
         redraw_label();
     }
 
@@ -112,6 +133,7 @@ public:
     // Set the label color of the text box
     void labelcolor(Fl_Color color) {
         Fl_Box::labelcolor(color);
+        invalidateCache();
         redraw_label();
     }
 
@@ -123,14 +145,73 @@ public:
     // Set the label font of the text box
     void labelfont(Fl_Font f) {
         Fl_Box::labelfont(f);
+        invalidateCache();
         redraw_label();
     }
 
+    // Keep a rendered copy of the text box and copy it on redraws until one of its properties changes
+    // Meant for static text on a plain background, see RenderCache
+    void cache(bool enabled) {
+        if (enabled == cached()) return;
+        renderCache.reset(enabled ? new RenderCache() : nullptr);
+        redraw();
+    }
+
+    // Check if the text box keeps a rendered copy
+    bool cached() const {
+        return renderCache != nullptr;
+    }
+
+    // Draw the text box, from its cache if it has one
+    void draw() override {
+        if (!renderCache) {
+            RenderStats::shared().rendered(w(), h());
+            paint();
+            return;
+        }
+        renderCache->draw(this, [this]() {
+            int ox = x(), oy = y();
+            x(0);
+            y(0);
+            paint();
+            x(ox);
+            y(oy);
+        });
+    }
+
+    // Move the text box to (nx, ny), redrawing only the area it left and the area it covers
+    // Unlike hide() and show(), this neither redraws the whole parent nor flickers
+    void moveTo(int nx, int ny) {
+        if (nx == x() && ny == y()) return;
+        Fl_Window *win = window();
+        if (!win || !visible_r()) {
+            position(nx, ny);
+            SpatialIndex::moved(this);
+            return;
+        }
+        // Widget coordinates are relative to the enclosing window, as damage() expects
+        win->damage(FL_DAMAGE_ALL, x(), y(), w(), h());
+        position(nx, ny);
+        SpatialIndex::moved(this);
+        win->damage(FL_DAMAGE_ALL, x(), y(), w(), h());
+    }
+
+    // Move the text box by (dx, dy)
+    void moveBy(int dx, int dy) {
+        moveTo(x() + dx, y() + dy);
+    }
+
     // Set the focus to the text box
     void take_focus() {
         Fl_Box::take_focus();
     }
 
+    // Destructor to remove the callbacks and release the label of the text box
+    ~TextBox() {
+        CallbackTable::clear(this);
+        LabelPool::release(this);
+    }
+
     // Friend declaration for AppTest struct
     friend struct ::AppTest;
 };
@@ -0,0 +1,478 @@
+#ifndef BOBCAT_UI_TILED_IMAGE
+#define BOBCAT_UI_TILED_IMAGE
+
+#include "bobcat_ui.h"
+#include "callbacks.h"
+#include "pixel_buffer.h"
+#include "resample.h"
+#include "worker_pool.h"
+#include <FL/Enumerations.H>
+#include <FL/Fl.H>
+#include <FL/Fl_Box.H>
+#include <FL/Fl_PNG_Image.H>
+#include <FL/fl_draw.H>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace bobcat {
+
+/**
+ * @brief Describes an image pyramid stored as PNG tiles on disk.
+ *
+ * Level 0 holds the image at full resolution and every further level halves
+ * it. By default tile (col, row) of a level is read from
+ * directory/level/col_row.png; set path to use another layout.
+ */
+struct TileSource {
+    std::string directory; // Root directory of the pyramid
+    int width; // Width of the full resolution image
+    int height; // Height of the full resolution image
+    int tileSize; // Width and height of a tile in pixels at its own level
+    int levels; // Number of levels
+    std::function<std::string(int level, int col, int row)> path; // Optional custom tile path
+
+    // Get the file of a tile
+    std::string tilePath(int level, int col, int row) const {
+        if (path) return path(level, col, row);
+        return directory + "/" + std::to_string(level) + "/" + std::to_string(col) + "_" + std::to_string(row) + ".png";
+    }
+};
+
+/**
+ * @class TiledImage
+ * @brief A pan and zoom viewer for images too large to decode at once.
+ *
+ * Only the tiles visible at the current zoom are decoded, on the shared
+ * WorkerPool, from the level whose resolution is closest above the screen
+ * resolution. Decoded tiles are kept in a bounded cache, least recently drawn
+ * first out, and the ring of tiles next to the view in the direction of the
+ * last pan is loaded ahead of time. While a tile loads, the closest coarser
+ * tile already in the cache is drawn in its place. Tiles are scaled to the
+ * zoom only where they show through the clip, and the scaled copies of tiles
+ * that left the screen are freed on the next draw, so scaled pixels never
+ * take more memory than the widget's area. Drag to pan, use the mouse wheel
+ * to zoom.
+ */
+class TiledImage : public Fl_Box {
+    // Identifies a tile by level, column and row
+    struct TileKey {
+        int level, col, row;
+
+        bool operator<(const TileKey &o) const {
+            if (level != o.level) return level < o.level;
+            if (col != o.col) return col < o.col;
+            return row < o.row;
+        }
+    };
+
+    // A cached tile
+    struct Tile {
+        Fl_RGB_Image *image; // Decoded tile, nullptr if the tile could not be read
+        Fl_Image *scaled; // Visible part of the tile scaled for the current zoom, only kept while on screen
+        int scaledW, scaledH; // Size the whole tile is scaled to
+        int scaledX, scaledY; // Position of scaled in the whole scaled tile
+        unsigned long frame; // Last frame the tile was drawn in
+        std::list<TileKey>::iterator use; // Position in the recency list
+    };
+
+    // State shared with the worker threads, which may outlive the widget
+    struct Loader {
+        std::mutex lock; // Guards finished
+        std::vector<std::pair<TileKey, PixelBuffer>> finished; // Decoded tiles waiting for the UI thread
+        std::atomic<bool> closed; // Set when the widget is destroyed
+
+        Loader() : closed(false) {}
+    };
+
+    TileSource source; // Where the tiles come from
+    double zoomFactor; // Screen pixels per full resolution pixel
+    double originX, originY; // Full resolution position shown at the top left corner
+    double lastDX, lastDY; // Direction of the last pan, for prefetching
+    int dragX, dragY; // Pointer position during a drag
+
+    std::map<TileKey, Tile> tiles; // Decoded tiles
+    std::list<TileKey> recency; // Cached tiles, most recently drawn first
+    size_t maxTiles; // Capacity of the tile cache
+    size_t wanted; // Tiles drawn or requested by the last draw, never trimmed
+    std::set<TileKey> inFlight; // Tiles being decoded
+    std::deque<TileKey> queue; // Tiles waiting for a worker, most wanted first
+    int maxInFlight; // Number of tiles decoded at the same time
+    unsigned long frames; // Number of draws so far
+    std::shared_ptr<Loader> loader; // Completion channel of the workers
+
+    // Get the zoom that fits the whole image in the widget
+    double fitZoom() const {
+        if (source.width <= 0 || source.height <= 0 || w() <= 0 || h() <= 0) return 1.0;
+        return std::min((double)w() / source.width, (double)h() / source.height);
+    }
+
+    // Get the level whose resolution is closest above the current zoom
+    int levelForZoom() const {
+        int level = 0;
+        double scale = zoomFactor;
+        while (level + 1 < source.levels && scale * 2.0 <= 1.0) {
+            scale *= 2.0;
+            level++;
+        }
+        return level;
+    }
+
+    // Get the number of tile columns and rows of a level
+    void gridSize(int level, int &cols, int &rows) const {
+        int lw = std::max(1, (int)ceil(source.width / pow(2.0, level)));
+        int lh = std::max(1, (int)ceil(source.height / pow(2.0, level)));
+        cols = (lw + source.tileSize - 1) / source.tileSize;
+        rows = (lh + source.tileSize - 1) / source.tileSize;
+    }
+
+    // Get the range of tiles of a level that intersect the view, grown by margin tiles
+    void visibleRange(int level, int margin, int &c0, int &r0, int &c1, int &r1) const {
+        double span = source.tileSize * pow(2.0, level);
+        int cols, rows;
+        gridSize(level, cols, rows);
+        c0 = std::max(0, (int)floor(originX / span) - margin);
+        r0 = std::max(0, (int)floor(originY / span) - margin);
+        c1 = std::min(cols - 1, (int)floor((originX + w() / zoomFactor) / span) + margin);
+        r1 = std::min(rows - 1, (int)floor((originY + h() / zoomFactor) / span) + margin);
+    }
+
+    // Queue a tile for decoding unless it is cached or already requested
+    void request(const TileKey &key, bool urgent) {
+        if (tiles.count(key) || inFlight.count(key)) return;
+        for (size_t i = 0; i < queue.size(); i++) {
+            if (!(queue[i] < key) && !(key < queue[i])) return;
+        }
+        if (urgent) {
+            queue.push_front(key);
+        } else {
+            queue.push_back(key);
+        }
+    }
+
+    // Hand queued tiles to the worker pool, keeping at most maxInFlight running
+    void startLoads() {
+        while (!queue.empty() && (int)inFlight.size() < maxInFlight) {
+            TileKey key = queue.front();
+            queue.pop_front();
+            inFlight.insert(key);
+
+            std::shared_ptr<Loader> channel = loader;
+            std::string file = source.tilePath(key.level, key.col, key.row);
+            WorkerPool::shared().submit([channel, key, file] {
+                if (channel->closed) return;
+                Fl_PNG_Image png(file.c_str());
+                PixelBuffer pixels = PixelBuffer::fromImage(&png);
+                std::lock_guard<std::mutex> guard(channel->lock);
+                channel->finished.push_back(std::make_pair(key, pixels));
+            });
+        }
+        if (!inFlight.empty() && !Fl::has_timeout(pollLoads, this)) {
+            Fl::add_timeout(1.0 / 60, pollLoads, this);
+        }
+    }
+
+    // Move decoded tiles into the cache on the UI thread
+    static void pollLoads(void *data) {
+        TiledImage *self = (TiledImage *)data;
+        std::vector<std::pair<TileKey, PixelBuffer>> ready;
+        {
+            std::lock_guard<std::mutex> guard(self->loader->lock);
+            ready.swap(self->loader->finished);
+        }
+        for (size_t i = 0; i < ready.size(); i++) {
+            const TileKey &key = ready[i].first;
+            self->inFlight.erase(key);
+            self->recency.push_front(key);
+            Tile tile;
+            tile.image = ready[i].second.empty() ? nullptr : ready[i].second.toImage();
+            tile.scaled = nullptr;
+            tile.scaledW = tile.scaledH = tile.scaledX = tile.scaledY = 0;
+            tile.frame = 0;
+            tile.use = self->recency.begin();
+            self->tiles[key] = tile;
+        }
+        if (!ready.empty()) {
+            self->trim();
+            self->redraw();
+        }
+        self->startLoads();
+        if (!self->inFlight.empty()) Fl::repeat_timeout(1.0 / 60, pollLoads, data);
+    }
+
+    // Drop the least recently drawn tiles beyond the cache capacity
+    // The tiles of the last frame are kept even if they are more than the capacity
+    void trim() {
+        size_t capacity = std::max(maxTiles, wanted);
+        while (tiles.size() > capacity && !recency.empty()) {
+            std::map<TileKey, Tile>::iterator it = tiles.find(recency.back());
+            delete it->second.image;
+            delete it->second.scaled;
+            tiles.erase(it);
+            recency.pop_back();
+        }
+    }
+
+    // Draw one tile at its screen position, requesting it if it is not cached
+    void drawTile(const TileKey &key) {
+        wanted++;
+        if (drawCached(key)) return;
+        request(key, true);
+
+        // Stand in with the closest coarser tile, clipped to this tile; the box color shows otherwise
+        double span = source.tileSize * pow(2.0, key.level);
+        int sx0 = x() + (int)floor((key.col * span - originX) * zoomFactor);
+        int sy0 = y() + (int)floor((key.row * span - originY) * zoomFactor);
+        int sx1 = x() + (int)floor(((key.col + 1) * span - originX) * zoomFactor);
+        int sy1 = y() + (int)floor(((key.row + 1) * span - originY) * zoomFactor);
+        for (int level = key.level + 1; level < source.levels; level++) {
+            int shift = level - key.level;
+            TileKey coarser = {level, key.col >> shift, key.row >> shift};
+            std::map<TileKey, Tile>::iterator it = tiles.find(coarser);
+            if (it == tiles.end() || !it->second.image) continue;
+            wanted++;
+            fl_push_clip(sx0, sy0, sx1 - sx0, sy1 - sy0);
+            drawCached(coarser);
+            fl_pop_clip();
+            return;
+        }
+    }
+
+    // Draw a cached tile at its screen position, returns false if it is not cached
+    // Only the part inside the current clip is scaled, so the copy never outgrows the widget
+    bool drawCached(const TileKey &key) {
+        std::map<TileKey, Tile>::iterator it = tiles.find(key);
+        if (it == tiles.end()) return false;
+
+        Tile &tile = it->second;
+        recency.splice(recency.begin(), recency, tile.use);
+        tile.frame = frames;
+        if (!tile.image) return true;
+
+        double span = source.tileSize * pow(2.0, key.level);
+        double scale = pow(2.0, key.level) * zoomFactor;
+        int sx0 = x() + (int)floor((key.col * span - originX) * zoomFactor);
+        int sy0 = y() + (int)floor((key.row * span - originY) * zoomFactor);
+        int sx1 = x() + (int)floor((key.col * span + tile.image->w() * pow(2.0, key.level) - originX) * zoomFactor);
+        int sy1 = y() + (int)floor((key.row * span + tile.image->h() * pow(2.0, key.level) - originY) * zoomFactor);
+        int tw = std::max(1, sx1 - sx0);
+        int th = std::max(1, sy1 - sy0);
+        if (fabs(scale - 1.0) <= 1e-6) {
+            tile.image->draw(sx0, sy0);
+            return true;
+        }
+
+        int cx, cy, cw, ch;
+        fl_clip_box(sx0, sy0, tw, th, cx, cy, cw, ch);
+        if (cw <= 0 || ch <= 0) return true;
+        int rx = cx - sx0, ry = cy - sy0;
+        if (!tile.scaled || tile.scaledW != tw || tile.scaledH != th || tile.scaledX != rx || tile.scaledY != ry ||
+            tile.scaled->w() != cw || tile.scaled->h() != ch) {
+            delete tile.scaled;
+            tile.scaled = Resampler::resize(tile.image, tw, th, rx, ry, cw, ch, RESAMPLE_BILINEAR);
+            tile.scaledW = tw;
+            tile.scaledH = th;
+            tile.scaledX = rx;
+            tile.scaledY = ry;
+        }
+        if (tile.scaled) tile.scaled->draw(cx, cy);
+        return true;
+    }
+
+    // Free the scaled copies of the tiles the last draw did not show
+    void dropScaled() {
+        for (std::map<TileKey, Tile>::iterator it = tiles.begin(); it != tiles.end(); ++it) {
+            Tile &tile = it->second;
+            if (tile.scaled && tile.frame != frames) {
+                delete tile.scaled;
+                tile.scaled = nullptr;
+            }
+        }
+    }
+
+    // Keep the view within the image
+    void clampView() {
+        double viewW = w() / zoomFactor;
+        double viewH = h() / zoomFactor;
+        originX = std::max(std::min(originX, source.width - viewW), 0.0);
+        originY = std::max(std::min(originY, source.height - viewH), 0.0);
+    }
+
+public:
+    // Constructor to initialize the viewer with position, size, and tile source
+    TiledImage(int x, int y, int w, int h, TileSource src) : Fl_Box(x, y, w, h) {
+        source = src;
+        if (source.tileSize <= 0) source.tileSize = 256;
+        if (source.levels <= 0) source.levels = 1;
+        box(FL_FLAT_BOX);
+        color(FL_BLACK);
+        originX = 0;
+        originY = 0;
+        lastDX = 0;
+        lastDY = 0;
+        dragX = 0;
+        dragY = 0;
+        maxTiles = 256;
+        wanted = 0;
+        maxInFlight = std::max(2, WorkerPool::shared().size());
+        frames = 0;
+        loader = std::make_shared<Loader>();
+        fitView();
+    }
+
+    // Zoom out so the whole image fits the widget
+    void fitView() {
+        zoomFactor = fitZoom();
+        originX = 0;
+        originY = 0;
+        redraw();
+    }
+
+    // Get the zoom factor in screen pixels per image pixel
+    double zoom() const {
+        return zoomFactor;
+    }
+
+    // Set the zoom factor, keeping the image point under (px, py) in place (widget coordinates)
+    void zoom(double factor, int px = -1, int py = -1) {
+        if (px < 0) px = w() / 2;
+        if (py < 0) py = h() / 2;
+        double minZoom = fitZoom() / 2.0;
+        factor = std::max(minZoom, std::min(factor, 32.0));
+        double ix = originX + px / zoomFactor;
+        double iy = originY + py / zoomFactor;
+        zoomFactor = factor;
+        originX = ix - px / zoomFactor;
+        originY = iy - py / zoomFactor;
+        clampView();
+        redraw();
+        CallbackTable::fire(this, EVENT_CHANGE);
+    }
+
+    // Move the view by a number of screen pixels
+    void pan(int dx, int dy) {
+        originX += dx / zoomFactor;
+        originY += dy / zoomFactor;
+        lastDX = dx;
+        lastDY = dy;
+        clampView();
+        redraw();
+        CallbackTable::fire(this, EVENT_CHANGE);
+    }
+
+    // Get the image position shown at the top left corner
+    double viewX() const {
+        return originX;
+    }
+
+    double viewY() const {
+        return originY;
+    }
+
+    // Set the number of tiles kept in memory, the tiles on screen are kept even beyond it
+    void cacheSize(size_t count) {
+        maxTiles = std::max((size_t)1, count);
+        trim();
+    }
+
+    // Get the number of tiles kept in memory
+    size_t cachedTiles() const {
+        return tiles.size();
+    }
+
+    // Set the onChange callback function
+    void onChange(std::function<void(bobcat::Widget *)> cb) {
+        CallbackTable::set(this, EVENT_CHANGE, cb);
+    }
+
+    // Draw the visible tiles and queue the missing and prefetched ones
+    void draw() override {
+        fl_push_clip(x(), y(), w(), h());
+        draw_box();
+
+        int level = levelForZoom();
+        int c0, r0, c1, r1;
+        visibleRange(level, 0, c0, r0, c1, r1);
+
+        // Drop queued requests that are no longer on screen
+        queue.clear();
+        wanted = 0;
+        frames++;
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                TileKey key = {level, c, r};
+                drawTile(key);
+            }
+        }
+
+        // Prefetch the ring of tiles in the direction of the last pan
+        int dc = lastDX > 0 ? 1 : (lastDX < 0 ? -1 : 0);
+        int dr = lastDY > 0 ? 1 : (lastDY < 0 ? -1 : 0);
+        if (dc != 0 || dr != 0) {
+            int cols, rows;
+            gridSize(level, cols, rows);
+            for (int r = r0 - 1; r <= r1 + 1; r++) {
+                for (int c = c0 - 1; c <= c1 + 1; c++) {
+                    if (r < 0 || c < 0 || r >= rows || c >= cols) continue;
+                    bool aheadC = dc != 0 && (dc > 0 ? c == c1 + 1 : c == c0 - 1);
+                    bool aheadR = dr != 0 && (dr > 0 ? r == r1 + 1 : r == r0 - 1);
+                    if (aheadC || aheadR) {
+                        TileKey key = {level, c, r};
+                        wanted++;
+                        request(key, false);
+                    }
+                }
+            }
+        }
+
+        fl_pop_clip();
+        dropScaled();
+        startLoads();
+    }
+
+    // Handle dragging and mouse wheel zooming
+    int handle(int event) override {
+        switch (event) {
+            case FL_PUSH:
+                dragX = Fl::event_x();
+                dragY = Fl::event_y();
+                return 1;
+            case FL_DRAG:
+                pan(dragX - Fl::event_x(), dragY - Fl::event_y());
+                dragX = Fl::event_x();
+                dragY = Fl::event_y();
+                return 1;
+            case FL_MOUSEWHEEL:
+                zoom(zoomFactor * (Fl::event_dy() < 0 ? 1.25 : 0.8), Fl::event_x() - x(), Fl::event_y() - y());
+                return 1;
+        }
+        return Fl_Box::handle(event);
+    }
+
+    // Destructor to stop the loads, remove the callbacks and delete the cached tiles
+    ~TiledImage() {
+        CallbackTable::clear(this);
+        loader->closed = true;
+        Fl::remove_timeout(pollLoads, this);
+        for (std::map<TileKey, Tile>::iterator it = tiles.begin(); it != tiles.end(); ++it) {
+            delete it->second.image;
+            delete it->second.scaled;
+        }
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+// bench_layout: time dragging the size of a window laid out by nested layouts
+//
+// Usage: bench_layout [--steps <n>]
+//
+// A window's content of about 5k widgets is built the way a large form lays
+// itself out: a column holding a toolbar row and 80 sections, each a grid of
+// 2 rows by 30 TextBoxes. The content is then resized the way dragging the
+// window's corner resizes it, one step per pixel pair (default 200 steps), by
+// changing the width, the height, both, and neither. The milliseconds per
+// step and the layouts run per step are printed; sections keep their height,
+// so a height-only drag should only run the outer column. Widgets are
+// created without a window, so no display is needed.
+//
+//     g++ -std=c++17 -O2 tools/bench_layout.cpp -o bench_layout $(fltk-config --ldflags)
+
+#include "../group.h"
+#include "../textbox.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Get the time since the first call in seconds
+static double now() {
+    static std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Build the content of the window, groups gets every group with a layout
+static bobcat::Group *build(std::vector<bobcat::Group *> &groups) {
+    bobcat::Group *content = new bobcat::Group(0, 0, 1200, 800);
+    bobcat::Layout &column = content->layout(bobcat::LAYOUT_COLUMN, 2, 4);
+    groups.push_back(content);
+
+    bobcat::Group *toolbar = new bobcat::Group(0, 0, 1200, 24);
+    bobcat::Layout &row = toolbar->layout(bobcat::LAYOUT_ROW, 2);
+    for (int i = 0; i < 20; i++) row.add(new bobcat::TextBox(0, 0, 60, 24, "Tool"), 0, 60);
+    toolbar->end();
+    column.add(toolbar, 0, 24, 24);
+    groups.push_back(toolbar);
+
+    for (int s = 0; s < 80; s++) {
+        bobcat::Group *section = new bobcat::Group(0, 0, 1200, 40);
+        bobcat::Layout &grid = section->layout(bobcat::LAYOUT_GRID, 1);
+        for (int r = 0; r < 2; r++) {
+            for (int c = 0; c < 30; c++) {
+                grid.cell(new bobcat::TextBox(0, 0, 30, 16, "Cell"), r, c, 1, 1, bobcat::Constraint(1, 20, 16, INT_MAX, 16));
+            }
+        }
+        section->end();
+        column.add(section, 0, 34);
+        groups.push_back(section);
+    }
+    content->end();
+    return content;
+}
+
+// Get the number of layout runs so far
+static size_t runs(const std::vector<bobcat::Group *> &groups) {
+    size_t total = 0;
+    for (size_t i = 0; i < groups.size(); i++) total += groups[i]->layout()->runCount();
+    return total;
+}
+
+int main(int argc, char **argv) {
+    int steps = 200;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--steps" && i + 1 < argc) {
+            steps = std::max(1, atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "Usage: %s [--steps <n>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<bobcat::Group *> groups;
+    bobcat::Group *content = build(groups);
+    content->layout()->apply();
+
+    const char *names[] = {"width", "height", "both", "none"};
+    const int dw[] = {2, 0, 2, 0};
+    const int dh[] = {0, 2, 2, 0};
+    int widgets = 0;
+    for (size_t i = 0; i < groups.size(); i++) widgets += groups[i]->children();
+    printf("%d widgets in %d layouts\n", widgets, (int)groups.size());
+    printf("%-8s %12s %14s\n", "Drag", "ms/step", "layouts/step");
+    for (int d = 0; d < 4; d++) {
+        content->resize(0, 0, 1200, 3200);
+        size_t before = runs(groups);
+        double start = now();
+        for (int i = 1; i <= steps; i++) content->resize(0, 0, 1200 + i * dw[d], 3200 + i * dh[d]);
+        double ms = (now() - start) / steps * 1000;
+        printf("%-8s %12.3f %14.1f\n", names[d], ms, (double)(runs(groups) - before) / steps);
+    }
+    delete content;
+    return 0;
+}
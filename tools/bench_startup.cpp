@@ -0,0 +1,108 @@
+// bench_startup: time loading startup images from files and from the AssetBundle
+//
+// Usage: bench_startup [--runs <n>] <file.png>...
+//
+// The given PNG files are loaded the way a program loads its images during
+// startup: once straight from the filesystem, once from an AssetBundle
+// holding the same bytes, as embed_assets would compile them in, and twice
+// from the bundle through ImageCache: a miss that decodes, then the hit a
+// second Image showing the same file gets. Only the first run reads cold
+// files; drop the page cache (echo 3 > /proc/sys/vm/drop_caches) before it,
+// or put the files in a network home directory, to see what the bundle saves.
+//
+//     g++ -std=c++17 -O2 tools/bench_startup.cpp -o bench_startup $(fltk-config --use-images --ldflags)
+
+#include "../asset_bundle.h"
+#include "../image_cache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Get the time since the first call in seconds
+static double now() {
+    static std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Read a whole file, returns false if it cannot be read
+static bool readFile(const std::string &path, std::vector<unsigned char> &out) {
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    unsigned char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+        out.insert(out.end(), buffer, buffer + n);
+    }
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+// Load every file once, returns the time in milliseconds or -1 if one failed to decode
+static double loadAll(const std::vector<std::string> &paths) {
+    double start = now();
+    for (size_t i = 0; i < paths.size(); i++) {
+        std::unique_ptr<Fl_PNG_Image> png(bobcat::AssetBundle::loadPNG(paths[i]));
+        if (png->fail()) return -1;
+    }
+    return (now() - start) * 1000;
+}
+
+// Load every file through the image cache, returns the time in milliseconds
+static double cacheAll(const std::vector<std::string> &paths) {
+    double start = now();
+    for (size_t i = 0; i < paths.size(); i++) bobcat::ImageCache::shared().load(paths[i]);
+    return (now() - start) * 1000;
+}
+
+int main(int argc, char **argv) {
+    int runs = 5;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            runs = std::max(1, atoi(argv[++i]));
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        fprintf(stderr, "Usage: %s [--runs <n>] <file.png>...\n", argv[0]);
+        return 1;
+    }
+
+    // Bundle the same bytes under other names, so the file paths still go to disk
+    std::vector<std::vector<unsigned char>> contents(files.size());
+    std::vector<std::string> names(files.size());
+    std::vector<bobcat::Asset> assets(files.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        if (!readFile(files[i], contents[i])) {
+            fprintf(stderr, "bench_startup: cannot read %s\n", files[i].c_str());
+            return 1;
+        }
+        names[i] = "bundled/" + files[i];
+        assets[i].name = names[i].c_str();
+        assets[i].data = contents[i].data();
+        assets[i].size = contents[i].size();
+    }
+    bobcat::AssetBundle::shared().add(assets.data(), assets.size());
+
+    printf("%-10s %12s %12s %12s %12s\n", "Run", "files ms", "bundle ms", "miss ms", "hit ms");
+    for (int r = 0; r < runs; r++) {
+        double fromFiles = loadAll(files);
+        double fromBundle = loadAll(names);
+        if (fromFiles < 0 || fromBundle < 0) {
+            fprintf(stderr, "bench_startup: a file is not a valid PNG\n");
+            return 1;
+        }
+        bobcat::ImageCache::shared().clear();
+        double firstLoad = cacheAll(names);
+        double secondLoad = cacheAll(names);
+        printf("%-10s %12.2f %12.2f %12.2f %12.2f\n", r == 0 ? "cold" : "warm", fromFiles, fromBundle, firstLoad, secondLoad);
+    }
+    return 0;
+}
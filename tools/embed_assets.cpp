@@ -0,0 +1,102 @@
+// embed_assets: compile PNG files into a C++ source file for bobcat::AssetBundle
+//
+// Usage: embed_assets <output.cpp> [--root <dir>] <file>...
+//
+// Each file is embedded under the path given on the command line. With --root,
+// that directory is stripped from the front of the following paths, so
+// "embed_assets assets.cpp --root res res/icon.png" embeds "icon.png".
+// Compile and link the output with the program; the assets register
+// themselves before main runs and are then found by ImageCache, Image and
+// TextureAtlas without reading the filesystem. PNG data is stored as is, it
+// is already compressed and decodes from memory as fast as from a file.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Read a whole file, returns false if it cannot be read
+static bool readFile(const std::string &path, std::vector<unsigned char> &out) {
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    unsigned char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+        out.insert(out.end(), buffer, buffer + n);
+    }
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+// Escape a path for use in a C++ string literal
+static std::string quote(const std::string &s) {
+    std::string out = "\"";
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '"' || s[i] == '\\') out += '\\';
+        out += s[i];
+    }
+    return out + "\"";
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <output.cpp> [--root <dir>] <file>...\n", argv[0]);
+        return 1;
+    }
+
+    std::string root;
+    std::vector<std::string> names;
+    std::vector<std::vector<unsigned char>> contents;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--root" && i + 1 < argc) {
+            root = argv[++i];
+            if (!root.empty() && root[root.size() - 1] != '/') root += '/';
+            continue;
+        }
+        std::vector<unsigned char> data;
+        if (!readFile(arg, data)) {
+            fprintf(stderr, "embed_assets: cannot read %s\n", arg.c_str());
+            return 1;
+        }
+        std::string name = arg;
+        if (!root.empty() && name.compare(0, root.size(), root) == 0) name = name.substr(root.size());
+        names.push_back(name);
+        contents.push_back(data);
+    }
+
+    FILE *out = fopen(argv[1], "w");
+    if (!out) {
+        fprintf(stderr, "embed_assets: cannot write %s\n", argv[1]);
+        return 1;
+    }
+
+    fprintf(out, "// Generated by embed_assets, do not edit\n\n");
+    fprintf(out, "#include \"asset_bundle.h\"\n\n");
+    fprintf(out, "namespace {\n\n");
+    for (size_t i = 0; i < contents.size(); i++) {
+        fprintf(out, "// %s\n", names[i].c_str());
+        fprintf(out, "const unsigned char asset%zu[] = {", i);
+        for (size_t k = 0; k < contents[i].size(); k++) {
+            fprintf(out, "%s%u,", k % 20 == 0 ? "\n    " : "", contents[i][k]);
+        }
+        fprintf(out, "\n};\n\n");
+    }
+
+    fprintf(out, "const bobcat::Asset assets[] = {\n");
+    for (size_t i = 0; i < contents.size(); i++) {
+        fprintf(out, "    {%s, asset%zu, %zu},\n", quote(names[i]).c_str(), i, contents[i].size());
+    }
+    if (contents.empty()) fprintf(out, "    {\"\", nullptr, 0},\n");
+    fprintf(out, "};\n\n");
+    fprintf(out, "const bobcat::AssetRegistration registration(assets, %zu);\n\n", contents.size());
+    fprintf(out, "}\n");
+
+    bool ok = !ferror(out);
+    if (fclose(out) != 0) ok = false;
+    if (!ok) {
+        fprintf(stderr, "embed_assets: error writing %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
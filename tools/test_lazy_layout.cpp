@@ -0,0 +1,79 @@
+// test_lazy_layout: check that a lazy group with a layout survives unloading
+//
+// Usage: test_lazy_layout
+//
+// A lazy column group builds three TextBoxes and adds them to its layout. It
+// is shown, laid out, hidden and unloaded, then resized while its children do
+// not exist and shown again: the layout must not touch the deleted children
+// and must place the rebuilt ones. Run it under AddressSanitizer to catch a
+// use after free. Widgets are created without a window, so no display is
+// needed. Prints every failed check and returns 1 if there was one.
+//
+//     g++ -std=c++17 -g -fsanitize=address tools/test_lazy_layout.cpp -o test_lazy_layout $(fltk-config --ldflags)
+
+#include "../group.h"
+#include "../textbox.h"
+#include <cstdio>
+
+// Reaches the private parts of Group for the test
+struct AppTest {
+    // Run the unload timeout of a lazy group now
+    static void unload(bobcat::Group *group) {
+        bobcat::Group::unload(group);
+    }
+};
+
+static int failures = 0;
+
+// Print a failed check
+static void check(bool ok, const char *what) {
+    if (ok) return;
+    printf("FAIL: %s\n", what);
+    failures++;
+}
+
+// Check that the children are stacked in a column inside the group's width
+static void checkColumn(bobcat::Group &group, const char *what) {
+    bool ok = group.children() == 3;
+    for (int i = 0; ok && i < group.children(); i++) {
+        Fl_Widget *child = group.child(i);
+        ok = child->x() == group.x() + 8 && child->w() == group.w() - 16 && child->y() >= group.y() + 8;
+        if (i > 0) ok = ok && child->y() > group.child(i - 1)->y();
+    }
+    check(ok, what);
+}
+
+int main() {
+    int builds = 0;
+    bobcat::Group group(0, 0, 400, 300);
+    group.end();
+    group.hide();
+    group.layout(bobcat::LAYOUT_COLUMN, 4, 8);
+    group.lazy([&builds](bobcat::Group *self) {
+        builds++;
+        for (int i = 0; i < 3; i++) {
+            self->layout()->add(new bobcat::TextBox(0, 0, 10, 10, "Row"), 1, 20);
+        }
+    }, 1);
+    check(!group.built() && group.children() == 0, "a hidden lazy group has no children");
+
+    group.show();
+    check(group.built() && builds == 1, "showing builds the children");
+    group.resize(0, 0, 400, 300);
+    checkColumn(group, "the layout places the built children");
+
+    group.hide();
+    AppTest::unload(&group);
+    check(!group.built() && group.children() == 0, "unloading deletes the children");
+    group.resize(0, 0, 500, 400);
+    group.layout()->apply();
+    check(group.layout()->minHeight() == 16, "an unloaded layout has no items");
+
+    group.show();
+    check(group.built() && builds == 2, "showing again rebuilds the children");
+    group.layout()->apply();
+    checkColumn(group, "the layout places the rebuilt children");
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+#ifndef BOBCAT_UI_VIRTUAL_LIST
+#define BOBCAT_UI_VIRTUAL_LIST
+
+#include "group.h"
+#include <FL/Enumerations.H>
+#include <FL/Fl.H>
+#include <FL/Fl_Scrollbar.H>
+#include <FL/fl_draw.H>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace bobcat {
+
+/**
+ * @class VirtualList
+ * @brief A scrolling list of rows that only creates the rows on screen.
+ *
+ * Rows are made by a factory, one more than fit in the list, and reused as
+ * the list scrolls: a row that leaves one edge is moved to the other and
+ * handed to the bind callback with its new index. Drawing, event handling and
+ * scrolling therefore cost the same for a hundred rows as for a million.
+ * A row can be any widget, usually a Group holding the widgets of one line.
+ */
+class VirtualList : public Group {
+    Fl_Scrollbar *scrollbar; // Vertical scrollbar
+    std::vector<Fl_Widget *> pool; // Reused rows
+    std::vector<int> bound; // Index bound to each row, -1 if none
+    std::function<Fl_Widget *(int x, int y, int w, int h)> createRow; // Makes a row
+    std::function<void(Fl_Widget *, int)> bindRow; // Shows the data of an index in a row
+    int rowH; // Height of a row
+    int total; // Number of rows in the list
+    int scrollY; // Scroll offset in pixels
+
+    // Get the width of a row
+    int rowW() const {
+        return w() - scrollbar->w();
+    }
+
+    // Make enough rows to cover the list with one to spare
+    void fillPool() {
+        if (!createRow) return;
+        size_t needed = (size_t)(h() / rowH + 2);
+        if (pool.size() >= needed) return;
+
+        Fl_Group *current = Fl_Group::current();
+        begin();
+        while (pool.size() < needed) {
+            Fl_Widget *row = createRow(x(), y(), rowW(), rowH);
+            if (row->parent() != this) add(row);
+            pool.push_back(row);
+        }
+        end();
+        Fl_Group::current(current);
+
+        // Rows are assigned by index modulo the pool size, which just changed
+        bound.assign(pool.size(), -1);
+    }
+
+    // Move and bind the rows for the current scroll position
+    void layoutRows() {
+        fillPool();
+        int maxY = std::max(0, total * rowH - h());
+        scrollY = std::max(0, std::min(scrollY, maxY));
+        scrollbar->value(scrollY, h(), 0, std::max(h(), total * rowH));
+
+        if (pool.empty()) return;
+        int n = (int)pool.size();
+        int first = scrollY / rowH;
+        for (int index = first; index < first + n; index++) {
+            int slot = index % n;
+            Fl_Widget *row = pool[slot];
+            if (index >= total) {
+                bound[slot] = -1;
+                if (row->visible()) row->hide();
+                continue;
+            }
+            int ry = y() + index * rowH - scrollY;
+            if (row->x() != x() || row->y() != ry || row->w() != rowW()) {
+                row->resize(x(), ry, rowW(), rowH);
+                SpatialIndex::moved(row);
+            }
+            if (bound[slot] != index) {
+                bound[slot] = index;
+                if (bindRow) bindRow(row, index);
+            }
+            if (!row->visible()) row->show();
+        }
+        redraw();
+    }
+
+    // Static handler function for scrollbar events
+    static void onScroll(Fl_Widget *, void *data) {
+        VirtualList *self = (VirtualList *)data;
+        self->scrollY = self->scrollbar->value();
+        self->layoutRows();
+    }
+
+public:
+    // Constructor to initialize the list with position, size, and row height
+    VirtualList(int x, int y, int w, int h, int rowHeight = 24) : Group(x, y, w, h) {
+        rowH = std::max(1, rowHeight);
+        total = 0;
+        scrollY = 0;
+        box(FL_DOWN_BOX);
+        color(FL_WHITE);
+        scrollbar = new Fl_Scrollbar(x + w - 16, y, 16, h);
+        scrollbar->callback(onScroll, this);
+        end();
+    }
+
+    // Set the row factory and the bind callback
+    // create makes a row at the given position and size, bind fills it with the data of an index
+    void rows(std::function<Fl_Widget *(int x, int y, int w, int h)> create, std::function<void(Fl_Widget *, int)> bind) {
+        createRow = create;
+        bindRow = bind;
+        layoutRows();
+    }
+
+    // Get the number of rows in the list
+    int count() const {
+        return total;
+    }
+
+    // Set the number of rows in the list, rows on screen are bound again
+    void count(int rows) {
+        total = std::max(0, rows);
+        bound.assign(pool.size(), -1);
+        layoutRows();
+    }
+
+    // Get the height of a row
+    int rowHeight() const {
+        return rowH;
+    }
+
+    // Scroll so the row at index is at the top
+    void scrollTo(int index) {
+        scrollY = index * rowH;
+        layoutRows();
+    }
+
+    // Get the index of the row at the top
+    int topRow() const {
+        return scrollY / rowH;
+    }
+
+    // Bind every row on screen again, after the data changed
+    void refresh() {
+        bound.assign(pool.size(), -1);
+        layoutRows();
+    }
+
+    // Bind one row again if it is on screen
+    void refresh(int index) {
+        if (pool.empty() || index < 0) return;
+        int slot = index % (int)pool.size();
+        if (bound[slot] == index && bindRow) bindRow(pool[slot], index);
+    }
+
+    // Scroll with the mouse wheel
+    int handle(int event) override {
+        if (event == FL_MOUSEWHEEL && Fl::event_inside(this)) {
+            scrollY += Fl::event_dy() * rowH;
+            layoutRows();
+            return 1;
+        }
+        return Group::handle(event);
+    }
+
+    // Draw the rows clipped to the list
+    void draw() override {
+        fl_push_clip(x(), y(), w(), h());
+        Group::draw();
+        fl_pop_clip();
+    }
+
+    // Keep the scrollbar on the right edge and cover the new height with rows
+    void resize(int x, int y, int w, int h) override {
+        Fl_Widget::resize(x, y, w, h);
+        scrollbar->resize(x + w - scrollbar->w(), y, scrollbar->w(), h);
+        SpatialIndex::moved(scrollbar);
+        layoutRows();
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
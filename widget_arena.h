@@ -0,0 +1,112 @@
+#ifndef BOBCAT_UI_WIDGET_ARENA
+#define BOBCAT_UI_WIDGET_ARENA
+
+#include "bobcat_ui.h"
+#include <FL/Fl_Group.H>
+#include <FL/Fl_Widget.H>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace bobcat {
+
+/**
+ * @class WidgetArena
+ * @brief Contiguous storage for widgets that are created and destroyed together.
+ *
+ * Widgets are placement-constructed one after another in large blocks instead
+ * of being allocated one by one, and the blocks are freed in one go. Before
+ * the memory goes away every widget is removed from its parent and its
+ * destructor is run, newest first, so FLTK never deletes a widget it did not
+ * allocate. Widgets from an arena must never be deleted directly.
+ */
+class WidgetArena {
+    std::vector<std::unique_ptr<char[]>> blocks; // Storage blocks, the last one is being filled
+    size_t used; // Bytes used in the last block
+    size_t capacity; // Size of the last block
+    size_t blockSize; // Size of new blocks
+    size_t reserved; // Bytes in all blocks
+    std::vector<Fl_Widget *> widgets; // Widgets in construction order
+
+    // Get the offset of the first address at or after base + from that is a multiple of align
+    static size_t aligned(const char *base, size_t from, size_t align) {
+        uintptr_t at = (uintptr_t)base + from;
+        return (size_t)((at + align - 1) / align * align - (uintptr_t)base);
+    }
+
+    // Get aligned memory for one object
+    void *allocate(size_t size, size_t align) {
+        size_t offset = blocks.empty() ? 0 : aligned(blocks.back().get(), used, align);
+        if (blocks.empty() || offset + size > capacity) {
+            capacity = std::max(blockSize, size + align);
+            blocks.push_back(std::unique_ptr<char[]>(new char[capacity]));
+            reserved += capacity;
+            offset = aligned(blocks.back().get(), 0, align);
+        }
+        used = offset + size;
+        return blocks.back().get() + offset;
+    }
+
+public:
+    // Constructor to set the size of the storage blocks
+    WidgetArena(size_t block = 64 * 1024) {
+        used = 0;
+        capacity = 0;
+        blockSize = block;
+        reserved = 0;
+    }
+
+    // Construct a widget in the arena and add it to a group
+    template <class T, class... Args>
+    T *create(Fl_Group *parent, Args &&... args) {
+        void *memory = allocate(sizeof(T), alignof(T));
+        // Keep the widget out of whatever group is being built, it goes into parent
+        Fl_Group *current = Fl_Group::current();
+        Fl_Group::current(nullptr);
+        T *widget = new (memory) T(std::forward<Args>(args)...);
+        Fl_Group::current(current);
+        widgets.push_back(widget);
+        if (parent) parent->add(widget);
+        return widget;
+    }
+
+    // Get the number of widgets in the arena
+    size_t count() const {
+        return widgets.size();
+    }
+
+    // Get the bytes reserved by the arena
+    size_t bytes() const {
+        return reserved;
+    }
+
+    // Destroy every widget, newest first, and free the storage
+    void clear() {
+        for (size_t i = widgets.size(); i-- > 0;) {
+            Fl_Widget *w = widgets[i];
+            if (w->parent()) w->parent()->remove(w);
+            w->~Fl_Widget();
+        }
+        widgets.clear();
+        blocks.clear();
+        used = 0;
+        capacity = 0;
+        reserved = 0;
+    }
+
+    // Destructor to destroy the widgets and free the storage
+    ~WidgetArena() {
+        clear();
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef BOBCAT_UI_WORKER_POOL
+#define BOBCAT_UI_WORKER_POOL
+
+#include "bobcat_ui.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bobcat {
+
+/**
+ * @class WorkerPool
+ * @brief A fixed set of background threads that run queued tasks.
+ *
+ * Tasks must not touch FLTK widgets or the GL context. Results that need the
+ * UI thread are handed back through Fl::awake or picked up in draw().
+ */
+class WorkerPool {
+    std::vector<std::thread> threads; // Worker threads
+    std::deque<std::function<void()>> tasks; // Pending tasks, oldest first
+    std::mutex lock; // Guards tasks and stopping
+    std::condition_variable wake; // Signalled when a task is queued or the pool stops
+    bool stopping; // Set when the pool is being destroyed
+
+    // Body of every worker thread
+    void loop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+    // Constructor to start the given number of threads (0 means one per core)
+    WorkerPool(unsigned int count = 0) {
+        stopping = false;
+        if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int i = 0; i < count; i++) {
+            threads.emplace_back([this] { loop(); });
+        }
+    }
+
+    // Get the pool shared by all bobcat components
+    static WorkerPool &shared() {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    // Get the number of worker threads
+    int size() const {
+        return (int)threads.size();
+    }
+
+    // Queue a task to run on a worker thread
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            tasks.push_back(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    // Run body(i) for every i in [0, count) across the pool and wait for all of them
+    // If body throws, the indices not yet started are skipped and the first exception is rethrown here
+    void parallelFor(int count, std::function<void(int)> body) {
+        if (count <= 0) return;
+        if (count == 1 || threads.size() <= 1) {
+            for (int i = 0; i < count; i++) body(i);
+            return;
+        }
+
+        // Shared with the helper tasks, which may start after this call has returned
+        struct State {
+            std::atomic<int> next;
+            std::atomic<int> remaining;
+            std::mutex doneLock;
+            std::condition_variable done;
+            std::function<void(int)> body;
+            int count;
+            std::exception_ptr error; // First exception thrown by body, guarded by doneLock
+            std::atomic<bool> failed; // Set once body has thrown, skips the remaining indices
+        };
+        std::shared_ptr<State> state = std::make_shared<State>();
+        state->next = 0;
+        state->remaining = count;
+        state->body = std::move(body);
+        state->count = count;
+        state->failed = false;
+
+        auto drain = [state] {
+            int i;
+            while ((i = state->next.fetch_add(1)) < state->count) {
+                // After a failure the remaining indices are only counted down, so the caller wakes up
+                if (!state->failed.load()) {
+                    try {
+                        state->body(i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> guard(state->doneLock);
+                        if (!state->error) state->error = std::current_exception();
+                        state->failed = true;
+                    }
+                }
+                if (state->remaining.fetch_sub(1) == 1) {
+                    std::lock_guard<std::mutex> guard(state->doneLock);
+                    state->done.notify_all();
+                }
+            }
+        };
+
+        int helpers = std::min(count - 1, (int)threads.size());
+        for (int i = 0; i < helpers; i++) {
+            submit(drain);
+        }
+        // The calling thread takes part instead of blocking idle
+        drain();
+
+        std::unique_lock<std::mutex> guard(state->doneLock);
+        state->done.wait(guard, [&] { return state->remaining.load() == 0; });
+        if (state->error) std::rethrow_exception(state->error);
+    }
+
+    // Destructor to finish the queued tasks and join the threads
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+    }
+
+    // Friend declaration for AppTest struct
+    friend struct ::AppTest;
+};
+
+}
+
+#endif